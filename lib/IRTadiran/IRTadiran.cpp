@@ -13,6 +13,7 @@
  */
 
 #include "IRTadiran.h"
+#include <string.h>
 
 // IR Protocol Constants
 #define IR_BUFFER_SIZE 264
@@ -82,6 +83,10 @@ uint16_t* IRTadiran::createBuffer() {
 }
 
 void IRTadiran::updateChecksum() {
+    code[7] = checksum(code);
+}
+
+uint8_t IRTadiran::checksum(const uint8_t* code) {
     int sum = 0;
     for (int i = 0; i < 7; i++) {
         sum += code[i];
@@ -91,7 +96,56 @@ void IRTadiran::updateChecksum() {
     int fan = (code[1] & 0xf0) >> 4;
     bool swing = (code[6] & 0xc0) != 0;
     
-    code[7] = sum - (0xf * (3 + temp / 8) + (fan) * 0xf + (swing ? 0xb4 : 0));
+    return sum - (0xf * (3 + temp / 8) + (fan) * 0xf + (swing ? 0xb4 : 0));
+}
+
+// Receivers see the same layout createBuffer() produces: header, then
+// 8 bytes LSB first where a long mark + short space is a 1 bit
+bool IRTadiran::decode(const uint16_t* durations, uint16_t count,
+                       bool& power, int& mode, int& fan, int& temperature, bool& swing) {
+    // Header plus 64 mark/space pairs
+    if (count < 2 + 8 * 8 * 2) {
+        return false;
+    }
+    if (durations[0] < 6000 || durations[0] > 10000 || durations[1] < 3000 || durations[1] > 5000) {
+        return false;
+    }
+    
+    uint8_t frame[8] = {0};
+    const uint16_t* bit = durations + 2;
+    for (int j = 0; j < 8; j++) {
+        for (int mask = 1; mask < 256; mask <<= 1, bit += 2) {
+            uint32_t period = bit[0] + bit[1];
+            if (period < 1500 || period > 2900) {
+                return false;
+            }
+            if (bit[0] > bit[1]) {
+                frame[j] |= mask;
+            }
+        }
+    }
+    
+    // The off frame is a fixed pattern with its own checksum
+    static const uint8_t OFF_FRAME[8] = {0x1, 0x14, 0x30, 0x0, 0x0, 0xc0, 0x0, 0x15};
+    if (memcmp(frame, OFF_FRAME, sizeof(frame)) == 0) {
+        power = false;
+        mode = 0;
+        fan = 1;
+        temperature = 24;
+        swing = false;
+        return true;
+    }
+    
+    if (frame[7] != checksum(frame) || (frame[5] & 0xf0) != 0x30) {
+        return false;
+    }
+    
+    power = true;
+    mode = frame[1] & 0xf;
+    fan = ((frame[1] & 0xf0) >> 4) - 1;
+    temperature = frame[2] / 2;
+    swing = (frame[6] & 0xc0) != 0;
+    return true;
 }
 
 void IRTadiran::setTemp(uint8_t temp) {
@@ -32,6 +32,15 @@ public:
     void setFan(uint8_t fan);
     void setMode(uint8_t mode);
     void setOn(bool isOn);
+    
+    // Decode a received frame (mark/space durations in microseconds, starting
+    // with the header mark) into the parameters send() would take for it.
+    // Returns false if the timings or the checksum do not match.
+    static bool decode(const uint16_t* durations, uint16_t count,
+                       bool& power, int& mode, int& fan, int& temperature, bool& swing);
+    
+    // Checksum byte for code[0..6], as sent in code[7]
+    static uint8_t checksum(const uint8_t* code);
 
 private:
     uint8_t code[8];
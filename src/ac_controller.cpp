@@ -89,6 +89,8 @@ const ACProtocol AC_PROTOCOLS[AC_MODEL_COUNT] = {
 };
 
 ACController::ACController(IRsend* irsend) : _irsend(irsend) {
+    _lastState = {DEFAULT_AC_MODEL, AC_MODE_OFF, 24, AC_FAN_MIN, false};
+    _lastTiming = {0, 0};
 }
 
 ACController::~ACController() {
@@ -98,30 +100,62 @@ bool ACController::sendCommand(int model, int mode, int temp, int fan, bool swin
     Serial.printf("Sending command for model %d: mode=%d, temp=%d, fan=%d, swing=%s\n", 
                   model, mode, temp, fan, swing ? "ON" : "OFF");
     
-    // Validate model index
-    if (model < 0 || model >= AC_MODEL_COUNT) {
-        Serial.printf("Invalid AC model: %d (using Tadiran as fallback)\n", model);
-        return sendTadiran(mode, temp, fan, swing);
+    // Everything before the first edge on the IR pin is encoding work
+    uint32_t start = micros();
+    PulseCache::armEdgeProbe();
+    bool success = dispatch(model, mode, temp, fan, swing);
+    uint32_t end = micros();
+    
+    uint32_t firstEdge;
+    if (PulseCache::takeFirstEdge(firstEdge)) {
+        _lastTiming.encodeUs = firstEdge - start;
+        _lastTiming.transmitUs = end - firstEdge;
+    } else {
+        _lastTiming.encodeUs = end - start;
+        _lastTiming.transmitUs = 0;
     }
+    return success;
+}
+
+// Clamp out-of-range parameters to defaults; returns AC_ADJUST_* flags
+uint8_t ACController::validate(int& mode, int& temp, int& fan) {
+    uint8_t adjusted = 0;
     
     // Validate temperature range
     if (temp < AC_TEMP_MIN || temp > AC_TEMP_MAX) {
         Serial.printf("Invalid temperature: %d°C (using 24°C as default)\n", temp);
         temp = 24;
+        adjusted |= AC_ADJUST_TEMP;
     }
     
     // Validate mode (0=OFF, 1=COOL, 2=HEAT, 3=FAN, 4=DRY, 5=AUTO)
     if (mode < AC_MODE_MIN || mode > AC_MODE_MAX) {
         Serial.printf("Invalid mode: %d (using COOL as default)\n", mode);
         mode = AC_MODE_COOL;
+        adjusted |= AC_ADJUST_MODE;
     }
     
     // Validate fan speed
     if (fan < AC_FAN_MIN || fan > AC_FAN_MAX) {
         Serial.printf("Invalid fan speed: %d (using 3 as default)\n", fan);
         fan = 3;
+        adjusted |= AC_ADJUST_FAN;
     }
     
+    return adjusted;
+}
+
+bool ACController::dispatch(int model, int mode, int temp, int fan, bool swing) {
+    // Validate model index
+    if (model < 0 || model >= AC_MODEL_COUNT) {
+        Serial.printf("Invalid AC model: %d (using Tadiran as fallback)\n", model);
+        _lastState = {AC_MODEL_TADIRAN, mode, temp, fan, swing};
+        return sendTadiran(mode, temp, fan, swing);
+    }
+    
+    validate(mode, temp, fan);
+    _lastState = {model, mode, temp, fan, swing};
+    
     // Special case for Tadiran (uses custom library)
     if (model == AC_MODEL_TADIRAN) {
         return sendTadiran(mode, temp, fan, swing);
@@ -134,6 +168,7 @@ bool ACController::sendCommand(int model, int mode, int temp, int fan, bool swin
     if (!protocol.implemented) {
         Serial.printf("AC model %d (%s) not yet implemented - using Tadiran as fallback\n", 
                      model, protocol.description);
+        _lastState.model = AC_MODEL_TADIRAN;
         return sendTadiran(mode, temp, fan, swing);
     }
     
@@ -143,6 +178,20 @@ bool ACController::sendCommand(int model, int mode, int temp, int fan, bool swin
 
 // Tadiran implementation (using existing IRTadiran library)
 bool ACController::sendTadiran(int mode, int temp, int fan, bool swing) {
+    uint32_t key = PulseCache::makeKey(AC_MODEL_TADIRAN, mode, temp, fan, swing);
+    
+    if (_cache.replay(key, _irsend)) {
+        Serial.println("Replayed cached Tadiran pulse train");
+        return true;
+    }
+    
+    _cache.beginCapture(false);
+    bool success = renderTadiran(mode, temp, fan, swing);
+    _cache.endCapture(key);
+    return success;
+}
+
+bool ACController::renderTadiran(int mode, int temp, int fan, bool swing) {
     bool power = (mode != AC_MODE_OFF);
     IRTadiran ir(_irsend);
     return ir.send(power, mode, fan, temp, swing);
@@ -150,8 +199,71 @@ bool ACController::sendTadiran(int mode, int temp, int fan, bool swing) {
 
 // Unified protocol handler for all IRremoteESP8266 protocols
 bool ACController::sendViaProtocol(decode_type_t protocol, int model, int mode, int temp, int fan, bool swing) {
+    uint32_t key = PulseCache::makeKey(model, mode, temp, fan, swing);
+    
+    // Cache hit: replay the rendered pulse train, no protocol encoding
+    if (_cache.replay(key, _irsend)) {
+        Serial.printf("Replayed cached pulse train for model %d\n", model);
+        return true;
+    }
+    
     Serial.printf("Sending via protocol %d for model %d\n", protocol, model);
     
+    // Cache miss: encode with IRac and capture the pulse train on the way out
+    _cache.beginCapture(false);
+    renderViaIRac(protocol, mode, temp, fan, swing);
+    _cache.endCapture(key);
+    
+    Serial.printf("Sent AC command: power=%s, mode=%d, temp=%d, fan=%d, swing=%s\n",
+                  mode != AC_MODE_OFF ? "ON" : "OFF", mode, temp, fan, swing ? "ON" : "OFF");
+    
+    return true;
+}
+
+// Warm-up entries come from a persisted list, so re-validate them
+bool ACController::warmCache(uint32_t key) {
+    int model, mode, temp, fan;
+    bool swing;
+    PulseCache::splitKey(key, model, mode, temp, fan, swing);
+    
+    if (model < 0 || model >= AC_MODEL_COUNT || !AC_PROTOCOLS[model].implemented ||
+        mode < AC_MODE_MIN || mode > AC_MODE_MAX || temp < AC_TEMP_MIN || temp > AC_TEMP_MAX ||
+        fan < AC_FAN_MIN || fan > AC_FAN_MAX) {
+        return false;
+    }
+    if (_cache.contains(key)) {
+        return true;
+    }
+    
+    // Two renders, since an entry is only stored once a second one confirms it
+    for (int i = 0; i < 2 && !_cache.contains(key); i++) {
+        _cache.beginCapture(true);
+        if (model == AC_MODEL_TADIRAN) {
+            renderTadiran(mode, temp, fan, swing);
+        } else {
+            renderViaIRac(AC_PROTOCOLS[model].protocol, mode, temp, fan, swing);
+        }
+        _cache.endCapture(key);
+    }
+    return _cache.contains(key);
+}
+
+decode_type_t ACController::protocolFor(int model) {
+    if (model <= AC_MODEL_TADIRAN || model >= AC_MODEL_COUNT || !AC_PROTOCOLS[model].implemented) {
+        return decode_type_t::UNKNOWN;
+    }
+    return AC_PROTOCOLS[model].protocol;
+}
+
+uint32_t ACController::cacheKey(int model, int mode, int temp, int fan, bool swing) {
+    if (model < 0 || model >= AC_MODEL_COUNT || !AC_PROTOCOLS[model].implemented) {
+        model = AC_MODEL_TADIRAN;
+    }
+    validate(mode, temp, fan);
+    return PulseCache::makeKey(model, mode, temp, fan, swing);
+}
+
+void ACController::renderViaIRac(decode_type_t protocol, int mode, int temp, int fan, bool swing) {
     // Helper functions for parameter mapping
     auto mapOpMode = [](int mode) -> stdAc::opmode_t {
         switch (mode) {
@@ -187,11 +299,4 @@ bool ACController::sendViaProtocol(decode_type_t protocol, int model, int mode,
     
     // Send the command
     ac.sendAc();
-    
-    Serial.printf("Sent AC command: power=%s, mode=%d, temp=%d, fan=%d, swing=%s\n",
-                  ac.next.power ? "ON" : "OFF", mode, temp, fan, swing ? "ON" : "OFF");
-    
-    return true;
 }
-
-
@@ -4,6 +4,29 @@
 #include <IRsend.h>
 #include <IRremoteESP8266.h>
 #include "config.h"
+#include "pulse_cache.h"
+
+// Effective (post-validation) parameters of a command
+struct ACState {
+    int model;
+    int mode;
+    int temp;
+    int fan;
+    bool swing;
+};
+
+// Fields ACController::validate() had to replace
+enum ACAdjust : uint8_t {
+    AC_ADJUST_TEMP = 1,
+    AC_ADJUST_MODE = 2,
+    AC_ADJUST_FAN = 4
+};
+
+// Duration of the last sendCommand(), split at the first IR edge
+struct ACTiming {
+    uint32_t encodeUs;
+    uint32_t transmitUs;
+};
 
 // Protocol mapping structure
 struct ACProtocol {
@@ -20,12 +43,42 @@ public:
     // Main control function
     bool sendCommand(int model, int mode, int temp, int fan, bool swing);
     
+    // Parameter validation shared with the HTTP layer
+    static uint8_t validate(int& mode, int& temp, int& fan);
+    
     // Model-specific control functions
     bool sendTadiran(int mode, int temp, int fan, bool swing);
     bool sendViaProtocol(decode_type_t protocol, int model, int mode, int temp, int fan, bool swing);
+    
+    // Parameters actually used by the last sendCommand() after validation
+    const ACState& lastState() const { return _lastState; }
+    const ACTiming& lastTiming() const { return _lastTiming; }
+    
+    // Take over a state observed from a physical remote as the shadow state
+    void adoptState(const ACState& state) { _lastState = state; }
+    
+    // Protocol a model's frames are sent with (UNKNOWN = Tadiran, including fallbacks)
+    static decode_type_t protocolFor(int model);
+    
+    // Pre-render a state into the pulse cache without transmitting
+    bool warmCache(uint32_t key);
+    
+    // Cache key sendCommand() will use for these parameters (after
+    // validation and the Tadiran fallback for unimplemented models)
+    static uint32_t cacheKey(int model, int mode, int temp, int fan, bool swing);
+    const PulseCache& cache() const { return _cache; }
+    PulseCache& cache() { return _cache; }
 
 private:
     IRsend* _irsend;
+    PulseCache _cache;
+    ACState _lastState;
+    ACTiming _lastTiming;
+    
+    bool dispatch(int model, int mode, int temp, int fan, bool swing);
+    
+    bool renderTadiran(int mode, int temp, int fan, bool swing);
+    void renderViaIRac(decode_type_t protocol, int mode, int temp, int fan, bool swing);
 };
 
 #endif // AC_CONTROLLER_H
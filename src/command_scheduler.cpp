@@ -0,0 +1,169 @@
+#include <string.h>
+#include "command_scheduler.h"
+
+#define TOKEN_SCALE 1000
+
+CommandScheduler::CommandScheduler()
+    : _count(0), _nextId(0), _hasShed(false), _maxDepth(0), _admitted(0), _rejectedRate(0), _rejectedFull(0),
+      _shed(0), _dispatched(0), _totalWait(0), _maxWait(0), _avgTransmit(ADMISSION_TRANSMIT_ESTIMATE_MS) {
+    memset(_queue, 0, sizeof(_queue));
+    memset(_clients, 0, sizeof(_clients));
+    memset(&_lastShed, 0, sizeof(_lastShed));
+}
+
+// ===== RATE LIMITING =====
+
+bool CommandScheduler::takeToken(uint32_t client, bool safety, uint32_t now, uint32_t& retryAfterSec) {
+    // Find the client's bucket, or recycle the least recently refilled one
+    ClientBucket* bucket = &_clients[0];
+    for (int i = 0; i < ADMISSION_MAX_CLIENTS; i++) {
+        if (_clients[i].client == client) {
+            bucket = &_clients[i];
+            break;
+        }
+        if ((int32_t)(_clients[i].lastRefill - bucket->lastRefill) < 0 || _clients[i].client == 0) {
+            bucket = &_clients[i];
+        }
+    }
+    if (bucket->client != client) {
+        bucket->client = client;
+        bucket->tokens = ADMISSION_BURST * TOKEN_SCALE;
+        bucket->safetyTokens = ADMISSION_SAFETY_BURST * TOKEN_SCALE;
+        bucket->lastRefill = now;
+    }
+
+    // Elapsed ms * tokens/s = tokens * 1000; cap so long idle periods cannot overflow
+    uint32_t elapsed = now - bucket->lastRefill;
+    if (elapsed > ADMISSION_BURST * TOKEN_SCALE) elapsed = ADMISSION_BURST * TOKEN_SCALE;
+    bucket->tokens += elapsed * ADMISSION_RATE_PER_SEC;
+    if (bucket->tokens > ADMISSION_BURST * TOKEN_SCALE) bucket->tokens = ADMISSION_BURST * TOKEN_SCALE;
+    bucket->safetyTokens += elapsed * ADMISSION_RATE_PER_SEC;
+    if (bucket->safetyTokens > ADMISSION_SAFETY_BURST * TOKEN_SCALE) {
+        bucket->safetyTokens = ADMISSION_SAFETY_BURST * TOKEN_SCALE;
+    }
+    bucket->lastRefill = now;
+
+    uint32_t& tokens = safety ? bucket->safetyTokens : bucket->tokens;
+    if (tokens < TOKEN_SCALE) {
+        uint32_t missingMs = (TOKEN_SCALE - tokens + ADMISSION_RATE_PER_SEC - 1) / ADMISSION_RATE_PER_SEC;
+        retryAfterSec = (missingMs + 999) / 1000;
+        return false;
+    }
+    tokens -= TOKEN_SCALE;
+    return true;
+}
+
+// ===== QUEUE =====
+
+AdmitResult CommandScheduler::admit(uint32_t client, uint8_t priority, uint32_t now, uint32_t& retryAfterSec) {
+    retryAfterSec = 0;
+
+    // Internal sources (client 0) are not rate limited; power-off is, from its own bucket
+    if (client != 0 && !takeToken(client, priority == PRIORITY_SAFETY, now, retryAfterSec)) {
+        _rejectedRate++;
+        return ADMIT_RATE_LIMITED;
+    }
+    return ADMIT_OK;
+}
+
+AdmitResult CommandScheduler::submit(QueuedCommand& command, uint32_t now, uint32_t& retryAfterSec) {
+    AdmitResult result = admit(command.client, command.priority, now, retryAfterSec);
+    if (result != ADMIT_OK) return result;
+
+    if (_count == ADMISSION_QUEUE_SIZE) {
+        // Make room by shedding the newest command of the lowest priority
+        // strictly below this one
+        int victim = -1;
+        for (size_t i = 0; i < _count; i++) {
+            if (_queue[i].priority <= command.priority) continue;
+            if (victim < 0 || _queue[i].priority > _queue[victim].priority ||
+                (_queue[i].priority == _queue[victim].priority && _queue[i].id > _queue[victim].id)) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            _rejectedFull++;
+            uint32_t drainMs = _count * _avgTransmit;
+            retryAfterSec = drainMs / 1000 + 1;
+            return ADMIT_QUEUE_FULL;
+        }
+        _lastShed = _queue[victim];
+        _hasShed = true;
+        remove(victim);
+        _shed++;
+    }
+
+    command.id = ++_nextId;
+    command.enqueuedAt = now;
+    _queue[_count++] = command;
+    if (_count > _maxDepth) _maxDepth = _count;
+    _admitted++;
+    return ADMIT_OK;
+}
+
+// Highest priority first, FIFO within a priority; the queue must not be empty
+size_t CommandScheduler::due() const {
+    size_t best = 0;
+    for (size_t i = 1; i < _count; i++) {
+        if (_queue[i].priority < _queue[best].priority ||
+            (_queue[i].priority == _queue[best].priority && _queue[i].id < _queue[best].id)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void CommandScheduler::dispatch(size_t index, QueuedCommand& command, uint32_t now) {
+    command = _queue[index];
+    remove(index);
+
+    uint32_t wait = now - command.enqueuedAt;
+    _dispatched++;
+    _totalWait += wait;
+    if (wait > _maxWait) _maxWait = wait;
+}
+
+bool CommandScheduler::next(QueuedCommand& command, uint32_t now) {
+    if (_count == 0) return false;
+    dispatch(due(), command, now);
+    return true;
+}
+
+bool CommandScheduler::takeIfNext(uint32_t id, QueuedCommand& command, uint32_t now) {
+    if (_count == 0) return false;
+    size_t index = due();
+    if (_queue[index].id != id) return false;
+    dispatch(index, command, now);
+    return true;
+}
+
+bool CommandScheduler::takeShed(QueuedCommand& command) {
+    if (!_hasShed) return false;
+    command = _lastShed;
+    _hasShed = false;
+    return true;
+}
+
+bool CommandScheduler::cancel(uint8_t source, QueuedCommand& command) {
+    int oldest = -1;
+    for (size_t i = 0; i < _count; i++) {
+        if (_queue[i].source != source) continue;
+        if (oldest < 0 || _queue[i].id < _queue[oldest].id) oldest = i;
+    }
+    if (oldest < 0) return false;
+    command = _queue[oldest];
+    remove(oldest);
+    return true;
+}
+
+void CommandScheduler::completed(uint32_t transmitMs) {
+    // Exponential moving average (1/4 weight) for Retry-After estimates
+    _avgTransmit = (_avgTransmit * 3 + transmitMs) / 4;
+}
+
+void CommandScheduler::remove(size_t index) {
+    for (size_t i = index + 1; i < _count; i++) {
+        _queue[i - 1] = _queue[i];
+    }
+    _count--;
+}
@@ -0,0 +1,103 @@
+#ifndef COMMAND_SCHEDULER_H
+#define COMMAND_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Lower value = served first
+enum CommandPriority : uint8_t {
+    PRIORITY_SAFETY = 0,    // Power off - never starved by other traffic
+    PRIORITY_NORMAL = 1
+};
+
+enum AdmitResult : uint8_t {
+    ADMIT_OK = 0,
+    ADMIT_RATE_LIMITED,
+    ADMIT_QUEUE_FULL
+};
+
+struct QueuedCommand {
+    uint32_t id;
+    uint32_t client;        // IPv4 address, 0 = internal source (not rate limited)
+    uint32_t enqueuedAt;    // ms
+    uint8_t priority;
+    uint8_t source;         // HistorySource
+    int model;              // -1 = saved model at execution time
+    int mode;               // As requested; ACController validates at transmit
+    int temp;
+    int fan;
+    bool swing;
+};
+
+// Admission control in front of ACController.
+// IR emission is slow and strictly serial, so commands are admitted into a
+// small bounded priority queue and transmitted one at a time from loop().
+// Each client gets a token bucket, plus a smaller one for power-off so it
+// is not starved by the client's other commands; when the queue is full (and nothing of
+// lower priority can be shed) the caller is told when to retry. Pure C++
+// with caller-supplied timestamps so it can be exercised on the host.
+class CommandScheduler {
+public:
+    CommandScheduler();
+
+    // Rate limit check alone, for commands that are not queued here
+    // (a group fan-out originating on this device)
+    AdmitResult admit(uint32_t client, uint8_t priority, uint32_t now, uint32_t& retryAfterSec);
+    AdmitResult submit(QueuedCommand& command, uint32_t now, uint32_t& retryAfterSec);
+    bool next(QueuedCommand& command, uint32_t now);
+
+    // Like next(), but only if the command with `id` is the one due
+    bool takeIfNext(uint32_t id, QueuedCommand& command, uint32_t now);
+
+    // The command the last submit() shed to make room, if any
+    bool takeShed(QueuedCommand& command);
+
+    // Remove the oldest pending command from `source`; call until it
+    // returns false to drop them all
+    bool cancel(uint8_t source, QueuedCommand& command);
+    void completed(uint32_t transmitMs);
+
+    // Statistics
+    size_t depth() const { return _count; }
+    size_t maxDepth() const { return _maxDepth; }
+    uint32_t admitted() const { return _admitted; }
+    uint32_t rejectedRate() const { return _rejectedRate; }
+    uint32_t rejectedFull() const { return _rejectedFull; }
+    uint32_t shed() const { return _shed; }
+    uint32_t maxWaitMs() const { return _maxWait; }
+    uint32_t avgWaitMs() const { return _dispatched > 0 ? _totalWait / _dispatched : 0; }
+    uint32_t avgTransmitMs() const { return _avgTransmit; }
+
+private:
+    struct ClientBucket {
+        uint32_t client;
+        uint32_t tokens;        // Scaled by 1000
+        uint32_t safetyTokens;  // Power-off has its own, smaller bucket
+        uint32_t lastRefill;
+    };
+
+    QueuedCommand _queue[ADMISSION_QUEUE_SIZE];
+    size_t _count;
+    uint32_t _nextId;
+    ClientBucket _clients[ADMISSION_MAX_CLIENTS];
+    QueuedCommand _lastShed;
+    bool _hasShed;
+
+    size_t _maxDepth;
+    uint32_t _admitted;
+    uint32_t _rejectedRate;
+    uint32_t _rejectedFull;
+    uint32_t _shed;
+    uint32_t _dispatched;
+    uint32_t _totalWait;
+    uint32_t _maxWait;
+    uint32_t _avgTransmit;
+
+    bool takeToken(uint32_t client, bool safety, uint32_t now, uint32_t& retryAfterSec);
+    size_t due() const;
+    void dispatch(size_t index, QueuedCommand& command, uint32_t now);
+    void remove(size_t index);
+};
+
+#endif // COMMAND_SCHEDULER_H
@@ -7,6 +7,8 @@
 
 // Hardware Configuration
 #define IR_LED_PIN 33
+#define IR_RECEIVE_PIN -1   // GPIO of an optional IR receiver module (e.g. TSOP38238); -1 = disabled
+#define THERMOSTAT_SENSOR_PIN -1  // ADC1 GPIO (32-39) of an optional NTC room sensor; -1 = disabled
 #define SERIAL_BAUD_RATE 115200
 
 // WiFi Configuration
@@ -14,12 +16,24 @@
 #define WIFI_AP_SSID "ACWebRemote"
 #define WIFI_AP_PASSWORD "12345678"
 #define WIFI_CONFIG_TIMEOUT 180  // 3 minutes
+#define NTP_SERVER "pool.ntp.org"
+#define MDNS_SERVICE "acremote"  // Advertised as _acremote._tcp for discovery (tools/acfleet)
 
 // Web Server Configuration
 #define WEB_SERVER_PORT 80
 #define ENDPOINT_SET "/set"
 #define ENDPOINT_CONFIG "/config"
 #define ENDPOINT_RESET "/reset"
+#define ENDPOINT_GROUP "/group"
+#define ENDPOINT_HISTORY "/api/history"
+#define ENDPOINT_AC_API "/api/ac"
+#define ENDPOINT_SCENE "/scene"
+#define ENDPOINT_DIAGNOSTICS "/api/diagnostics"
+#define ENDPOINT_OTA "/api/ota"
+#define ENDPOINT_THERMOSTAT "/api/thermostat"
+
+// Request Memory
+#define REQUEST_ARENA_SIZE 8192  // Per-request scratch space for JSON and argument parsing
 
 // AC Control Limits
 #define AC_TEMP_MIN 16
@@ -29,10 +43,93 @@
 #define AC_MODE_MIN 0
 #define AC_MODE_MAX 4
 
+// Admission Control (bounded priority queue in front of the IR transmitter)
+#define ADMISSION_QUEUE_SIZE 8               // Commands waiting for the transmitter
+#define ADMISSION_MAX_CLIENTS 8              // Clients with their own token bucket
+#define ADMISSION_RATE_PER_SEC 1             // Sustained commands per second per client
+#define ADMISSION_BURST 5                    // Commands a client may send back-to-back
+#define ADMISSION_SAFETY_BURST 3             // Power-offs a client may send back-to-back (separate bucket, same rate)
+#define ADMISSION_TRANSMIT_ESTIMATE_MS 300   // Initial transmit time estimate for Retry-After
+
+// Group Fan-out (UDP multicast between controllers)
+#define GROUP_MULTICAST_ADDR 239, 255, 42, 1
+#define GROUP_PORT 4210
+#define GROUP_NAME_MAX 15           // Characters per group name
+#define GROUP_MAX_MEMBERSHIPS 4     // Groups a single device can join
+#define GROUP_MAX_PEERS 32          // ACKs collected per command
+#define GROUP_DEDUP_WINDOW 16       // Recent (origin, seq) pairs remembered
+#define GROUP_SEND_REPEATS 2        // Datagram copies sent per command
+#define GROUP_ACK_TIMEOUT_MS 300    // How long the origin waits for ACKs
+
+// Command History
+#define HISTORY_CAPACITY 1024                 // Records kept (8 bytes each)
+#define HISTORY_CHECKPOINT_INTERVAL_MS 600000 // Flash checkpoint every 10 minutes
+#define HISTORY_MAX_BUCKETS 48                // e.g. two days of hourly buckets
+
+// Scenes (named command sequences stored and executed on the device)
+#define SCENE_MAX_SCENES 8            // Stored scenes
+#define SCENE_MAX_STEPS 6             // Commands per scene
+#define SCENE_NAME_MAX 15             // Characters per scene name ([A-Za-z0-9_-])
+#define SCENE_MAX_DELAY_MS 86400000   // Longest wait before a step (one day)
+#define SCENE_UDP_PORT 4211           // Trigger port: a datagram holding the scene name
+
+// Telemetry (kept in RTC memory across resets, checkpointed to NVS for power loss)
+#define TELEMETRY_HANDLER_HISTORY 16              // Recent handler runs kept
+#define TELEMETRY_NAME_MAX 11                     // Characters per handler name
+#define TELEMETRY_TREND_POINTS 24                 // Largest-free-block samples kept
+#define TELEMETRY_TREND_INTERVAL_MS 900000        // One trend point per 15 minutes (6 hours total)
+#define TELEMETRY_SAMPLE_INTERVAL_MS 1000         // Heap sampling period
+#define TELEMETRY_CHECKPOINT_INTERVAL_MS 600000   // NVS checkpoint every 10 minutes
+
+// OTA Updates (image pulled over HTTP into the inactive app partition)
+#define OTA_URL_MAX 191                   // Characters in the image URL
+#define OTA_READ_CHUNK 1024               // Compressed bytes read at a time
+#define OTA_WRITE_CHUNK 4096              // Decompressed bytes per flash write (one sector)
+#define OTA_PASS_BUDGET_MS 25             // Time spent downloading per loop pass
+#define OTA_STALL_TIMEOUT_MS 10000        // No data for this long drops the connection
+#define OTA_CONNECT_TIMEOUT_MS 1500       // TCP connect, and again for the response headers (blocks loop())
+#define OTA_MAX_RESUMES 5                 // Reconnects (with a Range request) before pausing
+#define OTA_RESUME_DELAY_MS 2000          // Wait before reconnecting
+#define OTA_RESTART_DELAY_MS 3000         // Time to read the result before rebooting into the new image
+#define OTA_HEATSHRINK_WINDOW_BITS 11     // heatshrink -w default
+#define OTA_HEATSHRINK_LOOKAHEAD_BITS 4   // heatshrink -l default
+
+// Thermostat (on-device control loop; temperatures in tenths of a degree C)
+#define THERMOSTAT_DEFAULT_TARGET 240             // 24.0 C
+#define THERMOSTAT_DEFAULT_HYSTERESIS 5           // Start at target +/- 0.5 C, stop at the other side
+#define THERMOSTAT_MAX_HYSTERESIS 50
+#define THERMOSTAT_DEFAULT_MIN_ON_MS 300000       // Compressor protection: run at least 5 minutes
+#define THERMOSTAT_DEFAULT_MIN_OFF_MS 180000      // ... and rest at least 3 minutes
+#define THERMOSTAT_MAX_MIN_TIME_MS 3600000
+#define THERMOSTAT_STALE_MS 900000                // No reading for 15 minutes stops the unit
+#define THERMOSTAT_SENSOR_INTERVAL_MS 10000       // Local sensor sampling period
+#define THERMOSTAT_SENSOR_SAMPLES 16              // ADC readings averaged per sample
+#define THERMOSTAT_NTC_SERIES_OHMS 10000          // Fixed resistor from 3.3 V to the sensor pin
+#define THERMOSTAT_NTC_NOMINAL_OHMS 10000         // NTC (pin to GND) resistance at 25 C
+#define THERMOSTAT_NTC_BETA 3950
+
 // IR Protocol Constants
 #define IR_BUFFER_SIZE 264
 #define IR_FREQUENCY 38
 
+// IR Receiver (physical remotes; only used when IR_RECEIVE_PIN is set)
+#define IR_RECEIVE_BUFFER_SIZE 1024     // Captured durations per frame
+#define IR_RECEIVE_TIMEOUT_MS 50        // Silence that ends a frame (Tadiran repeats are 31 ms apart)
+#define IR_RECEIVE_QUEUE_SIZE 4         // Decoded states waiting for the main loop
+#define IR_RECEIVE_TASK_STACK 4096
+#define IR_RECEIVE_TASK_PRIORITY 1
+#define IR_RECEIVE_TASK_CORE 0          // The Arduino loop (HTTP, transmit) runs on core 1
+#define IR_RECEIVE_POLL_MS 20
+#define IR_RECEIVE_ECHO_GUARD_MS 250    // Frames this soon after our own transmit are our echo
+
+// Pulse Train Cache (rendered IRac commands)
+#define PULSE_CACHE_SLOTS 16                // Distinct states kept
+#define PULSE_CACHE_MAX_PINNED 8            // Slots that scene steps may pin
+#define PULSE_CACHE_MAX_PULSES 800          // Mark/space durations per state
+#define PULSE_CACHE_PENDING 4               // First renders kept until a second render confirms them
+#define PULSE_CACHE_WARM_COUNT 8            // Most-used states pre-rendered at boot
+#define PULSE_CACHE_SAVE_INTERVAL_MS 600000 // Persist the warm-up list at most every 10 minutes
+
 // AC Modes
 enum ACMode {
     AC_MODE_OFF = 0,
@@ -0,0 +1,232 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string.h>
+#include "group_sync.h"
+
+#define GROUP_MAGIC 0x41435752  // "ACWR"
+#define GROUP_VERSION 2  // 2: 16-bit model/mode/temp/fan
+
+GroupSync groupSync;
+
+GroupSync::GroupSync() : _callback(nullptr), _started(false), _deviceId(0), _seq(0), _seenNext(0) {
+    memset(_groups, 0, sizeof(_groups));
+    memset(_seen, 0, sizeof(_seen));
+}
+
+void GroupSync::begin(GroupCommandCallback callback) {
+    _callback = callback;
+    // The efuse MAC holds byte 0 in its low bits; skip the first two OUI
+    // bytes so the ID is made of the NIC-specific part of the address
+    _deviceId = (uint32_t)(ESP.getEfuseMac() >> 16);
+    // Start from a random sequence so a rebooted origin is not mistaken
+    // for a duplicate by peers that still hold its old (origin, seq) pairs
+    if (_seq == 0) _seq = esp_random();
+
+    if (_started) _udp.stop();
+    _started = _udp.beginMulticast(IPAddress(GROUP_MULTICAST_ADDR), GROUP_PORT);
+    if (_started) {
+        Serial.printf("Group sync listening on %s:%d (device %08x)\n",
+                      IPAddress(GROUP_MULTICAST_ADDR).toString().c_str(), GROUP_PORT, _deviceId);
+    } else {
+        Serial.println("Failed to join group multicast address");
+    }
+}
+
+void GroupSync::handle() {
+    if (!_started) return;
+    while (_udp.parsePacket() > 0) {
+        processPacket(nullptr);
+    }
+}
+
+// ===== MEMBERSHIP =====
+
+// Names are stored as a comma-separated list and echoed in responses
+bool GroupSync::validName(const char* group) {
+    size_t len = strlen(group);
+    if (len == 0 || len > GROUP_NAME_MAX) return false;
+    for (size_t i = 0; i < len; i++) {
+        if (group[i] < 0x20 || group[i] > 0x7e || group[i] == ',') return false;
+    }
+    return true;
+}
+
+bool GroupSync::join(const char* group) {
+    if (!validName(group)) return false;
+    if (isMember(group)) return true;
+    for (int i = 0; i < GROUP_MAX_MEMBERSHIPS; i++) {
+        if (_groups[i][0] == '\0') {
+            strcpy(_groups[i], group);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GroupSync::leave(const char* group) {
+    for (int i = 0; i < GROUP_MAX_MEMBERSHIPS; i++) {
+        if (strcmp(_groups[i], group) == 0) {
+            _groups[i][0] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GroupSync::isMember(const char* group) const {
+    if (group[0] == '\0') return false;
+    for (int i = 0; i < GROUP_MAX_MEMBERSHIPS; i++) {
+        if (strcmp(_groups[i], group) == 0) return true;
+    }
+    return false;
+}
+
+void GroupSync::loadMembership(const char* list) {
+    memset(_groups, 0, sizeof(_groups));
+    char name[GROUP_NAME_MAX + 1];
+    size_t len = 0;
+    for (const char* p = list; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            name[len] = '\0';
+            if (len > 0) join(name);
+            len = 0;
+            if (*p == '\0') break;
+        } else if (len < GROUP_NAME_MAX) {
+            name[len++] = *p;
+        }
+    }
+}
+
+size_t GroupSync::membershipList(char* out, size_t outSize) const {
+    size_t pos = 0;
+    out[0] = '\0';
+    for (int i = 0; i < GROUP_MAX_MEMBERSHIPS; i++) {
+        if (_groups[i][0] == '\0') continue;
+        int written = snprintf(out + pos, outSize - pos, "%s%s", pos > 0 ? "," : "", _groups[i]);
+        if (written < 0 || (size_t)written >= outSize - pos) break;
+        pos += written;
+    }
+    return pos;
+}
+
+// ===== FAN-OUT =====
+
+static int16_t saturate(int value) {
+    return value < INT16_MIN ? INT16_MIN : value > INT16_MAX ? INT16_MAX : value;
+}
+
+bool GroupSync::sendCommand(const char* group, int model, int mode, int temp, int fan, bool swing, GroupResult& result) {
+    result = GroupResult();
+    if (!_started || !validName(group)) {
+        return false;
+    }
+
+    GroupPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = GROUP_MAGIC;
+    packet.version = GROUP_VERSION;
+    packet.type = GROUP_PACKET_COMMAND;
+    packet.origin = _deviceId;
+    packet.seq = ++_seq;
+    // Peers validate; out-of-range values must stay out of range on the wire
+    packet.model = saturate(model);
+    packet.mode = saturate(mode);
+    packet.temp = saturate(temp);
+    packet.fan = saturate(fan);
+    packet.swing = swing ? 1 : 0;
+    strcpy(packet.group, group);
+    result.seq = packet.seq;
+
+    // Repeats carry the same seq; peers execute once and re-ACK the rest
+    IPAddress multicast(GROUP_MULTICAST_ADDR);
+    for (int i = 0; i < GROUP_SEND_REPEATS; i++) {
+        transmit(packet, multicast);
+    }
+
+    // Execute locally while peers are working on theirs
+    result.localMember = isMember(group);
+    if (result.localMember && _callback) {
+        result.localSuccess = _callback(model, mode, temp, fan, swing);
+    }
+
+    unsigned long start = millis();
+    while (millis() - start < GROUP_ACK_TIMEOUT_MS) {
+        if (_udp.parsePacket() > 0) {
+            processPacket(&result);
+        } else {
+            delay(1);
+        }
+    }
+
+    Serial.printf("Group '%s' seq %u: %d peer ACK(s)\n", group, result.seq, result.ackCount);
+    return true;
+}
+
+// ===== PACKET HANDLING =====
+
+const GroupSync::SeenEntry* GroupSync::findSeen(uint32_t origin, uint32_t seq) const {
+    for (int i = 0; i < GROUP_DEDUP_WINDOW; i++) {
+        if (_seen[i].origin == origin && _seen[i].seq == seq) return &_seen[i];
+    }
+    return nullptr;
+}
+
+void GroupSync::remember(uint32_t origin, uint32_t seq, bool success) {
+    _seen[_seenNext].origin = origin;
+    _seen[_seenNext].seq = seq;
+    _seen[_seenNext].success = success;
+    _seenNext = (_seenNext + 1) % GROUP_DEDUP_WINDOW;
+}
+
+void GroupSync::processPacket(GroupResult* pending) {
+    GroupPacket packet;
+    int len = _udp.read(reinterpret_cast<uint8_t*>(&packet), sizeof(packet));
+    if (len != (int)sizeof(packet) || packet.magic != GROUP_MAGIC || packet.version != GROUP_VERSION) {
+        return;
+    }
+    packet.group[GROUP_NAME_MAX] = '\0';
+
+    if (packet.type == GROUP_PACKET_ACK) {
+        if (pending == nullptr || packet.origin != _deviceId || packet.seq != pending->seq) return;
+        for (int i = 0; i < pending->ackCount; i++) {
+            if (pending->acks[i].deviceId == packet.responder) return;
+        }
+        if (pending->ackCount < GROUP_MAX_PEERS) {
+            GroupAck& ack = pending->acks[pending->ackCount++];
+            ack.deviceId = packet.responder;
+            ack.ip = _udp.remoteIP();
+            ack.success = packet.status == 1;
+        }
+        return;
+    }
+
+    if (packet.type != GROUP_PACKET_COMMAND || packet.origin == _deviceId || !isMember(packet.group)) {
+        return;
+    }
+
+    const SeenEntry* seen = findSeen(packet.origin, packet.seq);
+    if (seen != nullptr) {
+        // Our earlier ACK may have been lost; answer again without resending IR
+        sendAck(packet, seen->success);
+        return;
+    }
+
+    Serial.printf("Group '%s' command from %08x (seq %u)\n", packet.group, packet.origin, packet.seq);
+    bool success = _callback ? _callback(packet.model, packet.mode, packet.temp, packet.fan, packet.swing == 1) : false;
+    remember(packet.origin, packet.seq, success);
+    sendAck(packet, success);
+}
+
+void GroupSync::sendAck(const GroupPacket& command, bool success) {
+    GroupPacket ack = command;
+    ack.type = GROUP_PACKET_ACK;
+    ack.responder = _deviceId;
+    ack.status = success ? 1 : 0;
+    transmit(ack, _udp.remoteIP());
+}
+
+void GroupSync::transmit(const GroupPacket& packet, const IPAddress& ip) {
+    _udp.beginPacket(ip, GROUP_PORT);
+    _udp.write(reinterpret_cast<const uint8_t*>(&packet), sizeof(packet));
+    _udp.endPacket();
+}
@@ -0,0 +1,99 @@
+#ifndef GROUP_SYNC_H
+#define GROUP_SYNC_H
+
+#include <WiFiUdp.h>
+#include <IPAddress.h>
+#include <stdint.h>
+#include "config.h"
+
+// Wire format shared by every controller on the LAN (little-endian, packed)
+enum GroupPacketType : uint8_t {
+    GROUP_PACKET_COMMAND = 1,
+    GROUP_PACKET_ACK = 2
+};
+
+struct __attribute__((packed)) GroupPacket {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint32_t origin;      // Device that issued the command
+    uint32_t seq;         // Per-origin sequence number
+    uint32_t responder;   // Acknowledging device (ACK only)
+    int16_t model;        // -1 = each peer uses its saved model
+    int16_t mode;         // Unvalidated; each peer checks the ranges
+    int16_t temp;
+    int16_t fan;
+    uint8_t swing;
+    uint8_t status;       // 1 = sent (ACK only)
+    char group[GROUP_NAME_MAX + 1];
+};
+
+// Acknowledgement collected from one peer
+struct GroupAck {
+    uint32_t deviceId;
+    IPAddress ip;
+    bool success;
+};
+
+// Result of a fan-out, filled by GroupSync::sendCommand()
+struct GroupResult {
+    uint32_t seq;
+    bool localMember;
+    bool localSuccess;
+    uint8_t ackCount;
+    GroupAck acks[GROUP_MAX_PEERS];
+};
+
+typedef bool (*GroupCommandCallback)(int model, int mode, int temp, int fan, bool swing);
+
+// Fans AC commands out to peer controllers with one multicast datagram.
+// Peers execute commands for groups they have joined, drop duplicates seen
+// within the dedup window and unicast an ACK back to the origin.
+class GroupSync {
+public:
+    GroupSync();
+
+    void begin(GroupCommandCallback callback);
+    void handle();
+
+    // Membership (persisted by the caller as a comma-separated list)
+    bool join(const char* group);
+    bool leave(const char* group);
+    bool isMember(const char* group) const;
+    static bool validName(const char* group);  // 1-15 printable characters, no ','
+    void loadMembership(const char* list);
+    size_t membershipList(char* out, size_t outSize) const;
+
+    // Send a command to every member of `group` and wait for ACKs
+    bool sendCommand(const char* group, int model, int mode, int temp, int fan, bool swing, GroupResult& result);
+
+    uint32_t deviceId() const { return _deviceId; }
+
+private:
+    WiFiUDP _udp;
+    GroupCommandCallback _callback;
+    bool _started;
+    uint32_t _deviceId;
+    uint32_t _seq;
+
+    char _groups[GROUP_MAX_MEMBERSHIPS][GROUP_NAME_MAX + 1];
+
+    // Recently executed (origin, seq) pairs
+    struct SeenEntry {
+        uint32_t origin;
+        uint32_t seq;
+        bool success;
+    };
+    SeenEntry _seen[GROUP_DEDUP_WINDOW];
+    uint8_t _seenNext;
+
+    const SeenEntry* findSeen(uint32_t origin, uint32_t seq) const;
+    void remember(uint32_t origin, uint32_t seq, bool success);
+    void processPacket(GroupResult* pending);
+    void sendAck(const GroupPacket& command, bool success);
+    void transmit(const GroupPacket& packet, const IPAddress& ip);
+};
+
+extern GroupSync groupSync;
+
+#endif // GROUP_SYNC_H
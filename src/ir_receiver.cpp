@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <IRac.h>
+#include <math.h>
+#include "IRTadiran.h"
+#include "ir_receiver.h"
+
+IRReceiver irReceiver;
+
+IRReceiver::IRReceiver()
+    : _irrecv(nullptr), _queue(nullptr), _task(nullptr), _frames(0), _decoded(0), _unknown(0),
+      _dropped(0), _overflows(0), _adopted(0), _ignored(0) {
+}
+
+bool IRReceiver::begin() {
+    if (IR_RECEIVE_PIN < 0) {
+        return false;
+    }
+
+    _queue = xQueueCreate(IR_RECEIVE_QUEUE_SIZE, sizeof(ReceivedState));
+    // save_buffer: decode() works on a copy while the ISR captures the next frame
+    _irrecv = new IRrecv(IR_RECEIVE_PIN, IR_RECEIVE_BUFFER_SIZE, IR_RECEIVE_TIMEOUT_MS, true);
+    _irrecv->enableIRIn();
+
+    if (xTaskCreatePinnedToCore(taskEntry, "ir_receive", IR_RECEIVE_TASK_STACK, this,
+                                IR_RECEIVE_TASK_PRIORITY, &_task, IR_RECEIVE_TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        _irrecv->disableIRIn();
+        Serial.println("Failed to start IR receive task");
+        return false;
+    }
+
+    Serial.printf("IR receiver listening on GPIO %d\n", IR_RECEIVE_PIN);
+    return true;
+}
+
+bool IRReceiver::poll(ReceivedState& state) {
+    return _queue != nullptr && xQueueReceive(_queue, &state, 0) == pdTRUE;
+}
+
+void IRReceiver::countOutcome(bool adopted) {
+    if (adopted) {
+        _adopted++;
+    } else {
+        _ignored++;
+    }
+}
+
+// ===== BACKGROUND TASK =====
+
+void IRReceiver::taskEntry(void* arg) {
+    static_cast<IRReceiver*>(arg)->run();
+}
+
+void IRReceiver::run() {
+    for (;;) {
+        if (_irrecv->decode(&_results)) {
+            _frames++;
+            if (_results.overflow) _overflows++;
+
+            ReceivedState state;
+            if (decodeCapture(_results, _durations, state)) {
+                _decoded++;
+                state.receivedAt = millis();
+                if (xQueueSend(_queue, &state, 0) != pdTRUE) _dropped++;
+            } else {
+                _unknown++;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(IR_RECEIVE_POLL_MS));
+    }
+}
+
+// Tadiran is not an IRremoteESP8266 protocol, so its frames are decoded
+// from the raw timings; everything else goes through IRac's state decoder
+bool IRReceiver::decodeCapture(const decode_results& results, uint16_t* durations, ReceivedState& state) {
+    // rawbuf[0] is the gap before the frame; the rest alternate mark/space
+    uint16_t count = 0;
+    for (uint16_t i = 1; i < results.rawlen && count < IR_RECEIVE_BUFFER_SIZE; i++) {
+        uint32_t us = results.rawbuf[i] * kRawTick;
+        durations[count++] = us > 0xffff ? 0xffff : us;
+    }
+
+    bool power, swing;
+    int mode, fan, temp;
+    if (IRTadiran::decode(durations, count, power, mode, fan, temp, swing)) {
+        // A valid checksum does not make the mode nibble one we know; only 1-4 are ever sent
+        if (power && (mode <= AC_MODE_OFF || mode > AC_MODE_MAX)) return false;
+        state.protocol = decode_type_t::UNKNOWN;
+        state.mode = power ? mode : AC_MODE_OFF;
+        state.temp = temp;
+        state.fan = fan;
+        state.swing = swing;
+        return true;
+    }
+
+    stdAc::state_t ac;
+    if (results.decode_type == decode_type_t::UNKNOWN || !IRAcUtils::decodeToState(&results, &ac)) {
+        return false;
+    }
+
+    state.protocol = ac.protocol;
+    if (!ac.power) {
+        state.mode = AC_MODE_OFF;
+    } else {
+        switch (ac.mode) {
+            case stdAc::opmode_t::kCool: state.mode = AC_MODE_COOL; break;
+            case stdAc::opmode_t::kHeat: state.mode = AC_MODE_HEAT; break;
+            case stdAc::opmode_t::kFan: state.mode = AC_MODE_CIRCULATE; break;
+            case stdAc::opmode_t::kDry: state.mode = AC_MODE_DRY; break;
+            default: return false;  // Auto has no equivalent in our mode set
+        }
+    }
+
+    float degrees = ac.celsius ? ac.degrees : (ac.degrees - 32) * 5 / 9;
+    state.temp = degrees > 0 ? (int8_t)lroundf(degrees) : -1;
+
+    switch (ac.fanspeed) {
+        case stdAc::fanspeed_t::kMin:
+        case stdAc::fanspeed_t::kLow: state.fan = 1; break;
+        case stdAc::fanspeed_t::kMedium: state.fan = 2; break;
+        case stdAc::fanspeed_t::kHigh: state.fan = 3; break;
+        case stdAc::fanspeed_t::kMax: state.fan = 4; break;
+        default: state.fan = -1; break;
+    }
+
+    state.swing = ac.swingv != stdAc::swingv_t::kOff;
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef IR_RECEIVER_H
+#define IR_RECEIVER_H
+
+#include <IRremoteESP8266.h>
+#include <IRrecv.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// An A/C state decoded from a physical remote
+struct ReceivedState {
+    decode_type_t protocol;   // UNKNOWN = Tadiran frame
+    int8_t mode;
+    int8_t temp;              // -1 = not reported
+    int8_t fan;               // -1 = not reported (e.g. auto fan)
+    bool swing;
+    uint32_t receivedAt;      // millis() when decoded
+};
+
+// Frames are captured by IRrecv (hardware timer + GPIO interrupt) and
+// decoded by a background task pinned to the core the Arduino loop does
+// not use, so decoding never delays HTTP handling or transmission.
+// Decoded states are handed to the loop through a FreeRTOS queue.
+class IRReceiver {
+public:
+    IRReceiver();
+
+    // Starts capture when IR_RECEIVE_PIN is set; returns false otherwise
+    bool begin();
+    bool enabled() const { return _task != nullptr; }
+
+    // Next decoded state, if any (non-blocking, called from loop())
+    bool poll(ReceivedState& state);
+
+    // Outcome of a polled state, as decided by the loop
+    void countOutcome(bool adopted);
+
+    // Statistics
+    uint32_t frames() const { return _frames; }
+    uint32_t decoded() const { return _decoded; }
+    uint32_t unknown() const { return _unknown; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t overflows() const { return _overflows; }
+    uint32_t adopted() const { return _adopted; }
+    uint32_t ignored() const { return _ignored; }
+
+    // Turn one capture into a state; `durations` is scratch space for
+    // IR_RECEIVE_BUFFER_SIZE entries. Static so recorded captures can be
+    // replayed through it on the host.
+    static bool decodeCapture(const decode_results& results, uint16_t* durations, ReceivedState& state);
+
+private:
+    IRrecv* _irrecv;
+    decode_results _results;
+    uint16_t _durations[IR_RECEIVE_BUFFER_SIZE];
+    QueueHandle_t _queue;
+    TaskHandle_t _task;
+
+    volatile uint32_t _frames;
+    volatile uint32_t _decoded;
+    volatile uint32_t _unknown;
+    volatile uint32_t _dropped;
+    volatile uint32_t _overflows;
+    uint32_t _adopted;
+    uint32_t _ignored;
+
+    static void taskEntry(void* arg);
+    void run();
+};
+
+extern IRReceiver irReceiver;
+
+#endif // IR_RECEIVER_H
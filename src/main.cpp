@@ -8,6 +8,8 @@
 #include <WiFiManager.h>
 #include <Preferences.h>
 #include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include <esp_ota_ops.h>
 
 #include "config.h"
 #ifdef __has_include
@@ -16,6 +18,15 @@
     #endif
 #endif
 #include "ac_controller.h"
+#include "request_arena.h"
+#include "group_sync.h"
+#include "state_history.h"
+#include "command_scheduler.h"
+#include "scene_store.h"
+#include "telemetry.h"
+#include "ir_receiver.h"
+#include "ota_updater.h"
+#include "thermostat.h"
 #include "IoTWebUI.h"
 #include "IoTWebUIManager.h"
 
@@ -24,23 +35,68 @@ WiFiManager wifiManager;
 WebServer server(WEB_SERVER_PORT);
 IRsend irsend(IR_LED_PIN);
 ACController acController(&irsend);
+CommandScheduler commandScheduler;
+Thermostat thermostat;
 Preferences preferences;
 IoTWebUIManager webManager(&server, &preferences, "ACWebRemote", "acconfig");
 
 // Global variables
 int currentACModel = DEFAULT_AC_MODEL;
+unsigned long lastCacheSave = 0;
+unsigned long lastHistoryCheckpoint = 0;
+unsigned long lastTelemetryCheckpoint = 0;
+int sceneRenderModel = -1;   // Model the scene steps were pre-rendered for
+bool sceneFanOut = false;    // A scene step is being fanned out to its zone
+unsigned long lastTransmitEnd = 0;
+HistorySource shadowSource = HISTORY_SOURCE_HTTP;   // Who last changed the shadow state
+uint32_t shadowUpdatedAt = 0;
+unsigned long lastSensorSample = 0;
+bool roomReadingLocal = false;   // Last room temperature came from the local sensor
 
 // Function declarations
 bool connectToWiFi();
 void setupWiFiManager();
 void setupWebServer();
 void acHandler();
+void groupHandler();
+void historyHandler();
+void acApiHandler();
+void sceneHandler();
+void saveScene(const char* name);
+void sendSceneList();
+void diagnosticsHandler();
+void addSessionJSON(JsonObject out, const TelemetrySession& session);
+void sendServerTiming(uint32_t parseUs, uint32_t validateUs, uint32_t encodeUs, uint32_t queueUs, uint32_t transmitUs);
+void otaHandler();
+void thermostatHandler();
+void sendThermostatStatus();
+void loadThermostat();
+void saveThermostat();
+ThermostatCommand unitState();
+void runThermostat();
+void sampleRoomSensor();
+void sendOtaStatus(int code);
 void resetHandler();
 void startConfigPortal();
+void warmPulseCache();
+void savePulseCacheWarmList();
+size_t prerenderScenes();
 
 void handleConfigSave(const String& data);
 String getConfigValue(const String& key, const String& defaultValue = "");
-void setConfigValue(const String& key, const String& value);
+void setConfigValue(const char* key, const char* value);
+void setConfigValue(const char* key, int value);
+int argInt(const char* name, int defaultValue);
+bool executeGroupCommand(int model, int mode, int temp, int fan, bool swing);
+bool executeSceneStep(const SceneStep& step);
+void sendGroupResult(const char* group, const GroupResult& result);
+void recordCommand(HistorySource source, bool sent);
+void cancelQueued(HistorySource source);
+void processReceivedStates();
+void applyReceivedState(const ReceivedState& received);
+AdmitResult submitCommand(HistorySource source, uint32_t client, int model, int mode, int temp, int fan, bool swing, uint32_t& retryAfterSec, uint32_t* id = nullptr);
+void processCommandQueue();
+bool executeQueued(const QueuedCommand& command);
 void setupCustomNavigation();
 String generateHomeContent();
 String generateConfigContent();
@@ -53,6 +109,9 @@ void setup() {
     delay(100);
     
     Serial.println("AC Web Remote Starting...");
+    
+    // Recover what the previous session was doing before this reset
+    telemetry.begin();
 
     // Initialize preferences for configuration storage
     preferences.begin("acconfig", false);
@@ -65,6 +124,21 @@ void setup() {
     currentACModel = savedModel;
     Serial.printf("Loaded AC Model: %d (%s)\n", currentACModel, AC_MODEL_NAMES[currentACModel]);
     
+    // Restore command history from the last checkpoint
+    stateHistory.begin();
+    
+    // Pre-render the most-used states so the first commands are cache hits
+    warmPulseCache();
+    
+    // Optional IR receiver keeps the shadow state in sync with physical remotes
+    irReceiver.begin();
+    
+    // On-device thermostat settings (and the optional room sensor)
+    loadThermostat();
+    if (THERMOSTAT_SENSOR_PIN >= 0) {
+        analogSetPinAttenuation(THERMOSTAT_SENSOR_PIN, ADC_11db);
+    }
+    
     // Setup WiFi Manager
     setupWiFiManager();
     
@@ -89,21 +163,87 @@ void setup() {
     // Setup additional web server endpoints (AC-specific endpoints)
     setupWebServer();
     
+    // Join saved groups and start listening for peer commands
+    groupSync.loadMembership(getConfigValue("groups", "").c_str());
+    groupSync.begin(executeGroupCommand);
+    
+    // Load scenes, pin their pulse trains and open the UDP trigger port
+    sceneStore.begin(executeSceneStep);
+    sceneStore.listen();
+    prerenderScenes();
+    
     Serial.println("AC Web Remote Ready!");
 }
 
 void loop() {
+    telemetry.loopTick();
+    
     // Check WiFi connection
     if (WiFi.status() != WL_CONNECTED) {
+        TelemetryScope scope("wifi");
+        unsigned long outageStart = millis();
         Serial.println("WiFi connection lost, attempting to reconnect...");
         if (!connectToWiFi()) {
             Serial.println("Reconnection failed, starting config portal");
             startConfigPortal();
         }
+        // Multicast membership and UDP sockets do not survive a reconnect
+        groupSync.begin(executeGroupCommand);
+        sceneStore.listen();
+        telemetry.recordWifiOutage(millis() - outageStart);
     }
     
     // Handle web server requests
     webManager.handleClient();
+    
+    // Handle commands fanned out by peer controllers
+    groupSync.handle();
+    
+    // UDP scene triggers and delayed scene steps
+    sceneStore.handle();
+    
+    // States decoded from physical remotes by the IR receive task
+    processReceivedStates();
+    
+    // Local control loop: only queues a command on a real start/stop or setting change
+    sampleRoomSensor();
+    runThermostat();
+    
+    // Transmit one admitted command per pass so requests keep being served
+    processCommandQueue();
+    
+    // Stream a few milliseconds of a pending firmware download into flash
+    otaUpdater.handle();
+    if (otaUpdater.restartDue()) {
+        Serial.println("Restarting into the new firmware...");
+        stateHistory.checkpoint();
+        telemetry.checkpoint();
+        ESP.restart();
+    }
+    
+    // Scene steps on the saved model must be re-rendered after a model change
+    if (sceneRenderModel != currentACModel && commandScheduler.depth() == 0) {
+        prerenderScenes();
+    }
+    
+    // Keep the pulse cache warm-up list current without wearing out flash
+    if (millis() - lastCacheSave >= PULSE_CACHE_SAVE_INTERVAL_MS) {
+        lastCacheSave = millis();
+        savePulseCacheWarmList();
+    }
+    
+    if (millis() - lastHistoryCheckpoint >= HISTORY_CHECKPOINT_INTERVAL_MS) {
+        lastHistoryCheckpoint = millis();
+        stateHistory.checkpoint();
+    }
+    
+    if (millis() - lastTelemetryCheckpoint >= TELEMETRY_CHECKPOINT_INTERVAL_MS) {
+        lastTelemetryCheckpoint = millis();
+        telemetry.checkpoint();
+    }
+    
+    // Everything allocated while answering the request is released here
+    requestArena.reset();
 }
 
 void setupWiFiManager() {
@@ -122,6 +262,13 @@ void setupWiFiManager() {
 void setupWebServer() {
     // Add AC-specific endpoints (IoTWebUIManager handles common endpoints)
     server.on(ENDPOINT_SET, acHandler);
+    server.on(ENDPOINT_GROUP, groupHandler);
+    server.on(ENDPOINT_HISTORY, historyHandler);
+    server.on(ENDPOINT_AC_API, acApiHandler);
+    server.on(ENDPOINT_SCENE, sceneHandler);
+    server.on(ENDPOINT_DIAGNOSTICS, diagnosticsHandler);
+    server.on(ENDPOINT_OTA, otaHandler);
+    server.on(ENDPOINT_THERMOSTAT, thermostatHandler);
     server.on(ENDPOINT_RESET, resetHandler);
     
     // Note: IoTWebUIManager already handles:
@@ -150,8 +297,13 @@ bool connectToWiFi() {
             Serial.println("mDNS responder started");
             Serial.printf("Address: %s.local\n", WIFI_HOSTNAME);
             MDNS.addService("http", "tcp", WEB_SERVER_PORT);
+            // Lets fleet tools find AC remotes without matching every web server on the LAN
+            MDNS.addService(MDNS_SERVICE, "tcp", WEB_SERVER_PORT);
         }
         
+        // Wall-clock time for command history timestamps
+        configTime(0, 0, NTP_SERVER);
+        
         return true;
     } else {
         Serial.println("Failed to connect to WiFi");
@@ -160,30 +312,68 @@ bool connectToWiFi() {
 }
 
 void acHandler() {
-    if (server.hasArg("mode") && (server.hasArg("temp") || server.arg("mode").toInt() == AC_MODE_OFF)) {
-        // Update current model if provided, otherwise use saved model
+    TelemetryScope scope("set");
+    
+    if (server.hasArg("mode") && (server.hasArg("temp") || argInt("mode", -1) == AC_MODE_OFF)) {
+        // Model if provided, otherwise the saved model; it is only saved once
+        // a local command has been admitted
+        int model = currentACModel;
         if (server.hasArg("model")) {
-            int newModel = server.arg("model").toInt();
-            if (newModel < 0) newModel = 0;
-            if (newModel >= AC_MODEL_COUNT) newModel = AC_MODEL_COUNT - 1;
-            currentACModel = newModel;
-            setConfigValue("acmodel", String(currentACModel));
-            Serial.printf("AC Model changed to: %d (%s)\n", currentACModel, AC_MODEL_NAMES[currentACModel]);
+            model = argInt("model", currentACModel);
+            if (model < 0) model = 0;
+            if (model >= AC_MODEL_COUNT) model = AC_MODEL_COUNT - 1;
         }
         
-        int mode = server.arg("mode").toInt();
-        int temp = server.hasArg("temp") ? server.arg("temp").toInt() : 0;
-        int fan = server.hasArg("fan") ? server.arg("fan").toInt() : AC_FAN_MIN;
-        bool swing = server.hasArg("swing") ? (server.arg("swing").toInt() == 1) : false;
+        int mode = argInt("mode", AC_MODE_OFF);
+        int temp = argInt("temp", 0);
+        int fan = argInt("fan", AC_FAN_MIN);
+        bool swing = argInt("swing", 0) == 1;
         
         Serial.printf("AC Command: Model=%d (%s), Mode=%d, Temp=%d, Fan=%d, Swing=%s\n", 
-                      currentACModel, AC_MODEL_NAMES[currentACModel], mode, temp, fan, swing ? "ON" : "OFF");
+                      model, AC_MODEL_NAMES[model], mode, temp, fan, swing ? "ON" : "OFF");
         
-        bool success = acController.sendCommand(currentACModel, mode, temp, fan, swing);
-        if (success) {
-            server.send(200, "text/plain", "AC command sent successfully!");
+        // Fan out to every member of a group with a single multicast datagram.
+        // Members apply the model themselves; this device's own is left alone.
+        if (server.hasArg("group")) {
+            String group = server.arg("group");
+            if (!server.hasArg("model")) model = -1;
+            
+            // One fan-out costs the client one token here, like a local command
+            uint32_t retryAfter = 0;
+            if (commandScheduler.admit((uint32_t)server.client().remoteIP(),
+                                       mode == AC_MODE_OFF ? PRIORITY_SAFETY : PRIORITY_NORMAL,
+                                       millis(), retryAfter) != ADMIT_OK) {
+                stateHistory.append(HISTORY_SOURCE_GROUP, model < 0 ? currentACModel : model, mode, temp, fan, swing, false);
+                telemetry.countRejected();
+                server.sendHeader("Retry-After", String(retryAfter));
+                server.send(429, "text/plain", "Too many commands from this client");
+                return;
+            }
+            
+            GroupResult result;
+            if (!groupSync.sendCommand(group.c_str(), model, mode, temp, fan, swing, result)) {
+                server.send(400, "text/plain", "Invalid group or group sync not running");
+                return;
+            }
+            sendGroupResult(group.c_str(), result);
+            return;
+        }
+        
+        uint32_t retryAfter = 0;
+        AdmitResult result = submitCommand(HISTORY_SOURCE_HTTP, (uint32_t)server.client().remoteIP(),
+                                           model, mode, temp, fan, swing, retryAfter);
+        if (result == ADMIT_OK) {
+            // A rejected request must not leave a new model behind
+            if (model != currentACModel) {
+                currentACModel = model;
+                setConfigValue("acmodel", currentACModel);
+                Serial.printf("AC Model changed to: %d (%s)\n", currentACModel, AC_MODEL_NAMES[currentACModel]);
+            }
+            server.send(202, "text/plain", "AC command queued");
         } else {
-            server.send(500, "text/plain", "Failed to send AC command");
+            server.sendHeader("Retry-After", String(retryAfter));
+            server.send(429, "text/plain", result == ADMIT_RATE_LIMITED ? "Too many commands from this client"
+                                                                         : "Command queue full");
         }
     } else {
         Serial.println("Incorrect Command - missing required parameters");
@@ -193,20 +383,998 @@ void acHandler() {
     }
 }
 
+// Parse a numeric query argument without keeping a String around.
+// Numeric values fit in String's inline buffer, so this stays off the heap.
+int argInt(const char* name, int defaultValue) {
+    if (!server.hasArg(name)) {
+        return defaultValue;
+    }
+    return atoi(server.arg(name).c_str());
+}
+
+
+
+
+
+void groupHandler() {
+    TelemetryScope scope("group");
+    
+    char list[GROUP_MAX_MEMBERSHIPS * (GROUP_NAME_MAX + 1)];
+    
+    if (server.hasArg("join") || server.hasArg("leave")) {
+        bool ok = server.hasArg("join") ? groupSync.join(server.arg("join").c_str())
+                                        : groupSync.leave(server.arg("leave").c_str());
+        if (!ok) {
+            server.send(400, "text/plain", "Invalid group name or membership limit reached");
+            return;
+        }
+        groupSync.membershipList(list, sizeof(list));
+        setConfigValue("groups", list);
+        Serial.printf("Group membership: %s\n", list);
+        
+        // Zone steps now transmit here (or no longer do)
+        sceneRenderModel = -1;
+    } else {
+        groupSync.membershipList(list, sizeof(list));
+    }
+    
+    server.send(200, "text/plain", list);
+}
+
+// Admits a group command (model -1 = use the saved model); the ACK reports admission.
+// Our own scene's zone steps stay scene commands so the scene is not cancelled by itself.
+bool executeGroupCommand(int model, int mode, int temp, int fan, bool swing) {
+    uint32_t retryAfter = 0;
+    return submitCommand(sceneFanOut ? HISTORY_SOURCE_SCENE : HISTORY_SOURCE_GROUP, 0, model, mode, temp, fan,
+                         swing, retryAfter) == ADMIT_OK;
+}
+
+// Scene steps bypass the per-client rate limit like group commands; a step
+// with a zone is fanned out (and runs here too if this device is a member)
+bool executeSceneStep(const SceneStep& step) {
+    if (step.zone[0] != '\0') {
+        GroupResult result;
+        sceneFanOut = true;
+        bool sent = groupSync.sendCommand(step.zone, step.model, step.mode, step.temp, step.fan, step.swing == 1, result);
+        sceneFanOut = false;
+        return sent;
+    }
+    uint32_t retryAfter = 0;
+    return submitCommand(HISTORY_SOURCE_SCENE, 0, step.model, step.mode, step.temp, step.fan, step.swing == 1,
+                         retryAfter) == ADMIT_OK;
+}
+
+AdmitResult submitCommand(HistorySource source, uint32_t client, int model, int mode, int temp, int fan, bool swing, uint32_t& retryAfterSec, uint32_t* id) {
+    QueuedCommand command;
+    command.client = client;
+    command.priority = mode == AC_MODE_OFF ? PRIORITY_SAFETY : PRIORITY_NORMAL;
+    command.source = source;
+    command.model = model;
+    command.mode = mode;
+    command.temp = temp;
+    command.fan = fan;
+    command.swing = swing;
+    
+    AdmitResult result = commandScheduler.submit(command, millis(), retryAfterSec);
+    if (result != ADMIT_OK) {
+        Serial.printf("Command rejected (%s), retry after %u s\n",
+                      result == ADMIT_RATE_LIMITED ? "rate limited" : "queue full", retryAfterSec);
+        stateHistory.append(source, model < 0 ? currentACModel : model, mode, temp, fan, swing, false);
+        telemetry.countRejected();
+        return result;
+    }
+    if (id != nullptr) {
+        *id = command.id;
+    }
+    
+    // A full queue makes room by dropping a lower-priority command that was already accepted
+    QueuedCommand shed;
+    if (commandScheduler.takeShed(shed)) {
+        Serial.printf("Command %u shed for a higher-priority command\n", shed.id);
+        stateHistory.append((HistorySource)shed.source, shed.model < 0 ? currentACModel : shed.model,
+                            shed.mode, shed.temp, shed.fan, shed.swing, false);
+        telemetry.countRejected();
+    }
+    return result;
+}
+
+void processCommandQueue() {
+    QueuedCommand command;
+    if (commandScheduler.next(command, millis())) {
+        executeQueued(command);
+    }
+}
+
+bool executeQueued(const QueuedCommand& command) {
+    TelemetryScope scope("transmit");
+    
+    int model = command.model;
+    if (model < 0 || model >= AC_MODEL_COUNT) {
+        model = currentACModel;
+    }
+    
+    unsigned long start = millis();
+    bool success = acController.sendCommand(model, command.mode, command.temp, command.fan, command.swing);
+    lastTransmitEnd = millis();
+    commandScheduler.completed(lastTransmitEnd - start);
+    recordCommand((HistorySource)command.source, success);
+    telemetry.countCommand(success);
+    return success;
+}
+
+// JSON command API: GET returns the shadow state, POST applies a partial
+// update on top of it and reports what was actually sent
+void acApiHandler() {
+    TelemetryScope scope("api_ac");
+    
+    uint32_t t0 = micros();
+    
+    // Shadow state: last effective command, on the saved model
+    ACState state = acController.lastState();
+    state.model = currentACModel;
+    
+    JsonDocument response(&requestArena);
+    
+    if (server.method() != HTTP_POST) {
+        JsonObject current = response["state"].to<JsonObject>();
+        current["model"] = state.model;
+        current["model_name"] = AC_MODEL_NAMES[state.model];
+        current["mode"] = state.mode;
+        current["temp"] = state.temp;
+        current["fan"] = state.fan;
+        current["swing"] = state.swing;
+        if (shadowUpdatedAt != 0) {
+            static const char* SOURCE_NAMES[] = {"http", "group", "api", "scene", "remote", "thermostat"};
+            current["updated_by"] = SOURCE_NAMES[shadowSource];
+            current["updated_at"] = shadowUpdatedAt;
+        }
+        
+        String json;
+        json.reserve(measureJson(response) + 1);
+        serializeJson(response, json);
+        sendServerTiming(0, 0, 0, 0, 0);
+        server.send(200, "application/json", json);
+        return;
+    }
+    
+    // Parse
+    JsonDocument patch(&requestArena);
+    const String& body = server.arg("plain");
+    DeserializationError error = deserializeJson(patch, body.c_str(), body.length());
+    uint32_t t1 = micros();
+    if (error || !patch.is<JsonObject>()) {
+        sendServerTiming(t1 - t0, 0, 0, 0, 0);
+        server.send(400, "text/plain", "Body must be a JSON object");
+        return;
+    }
+    
+    // Validate: merge the patch over the shadow state, then clamp
+    static const char* FIELDS[] = {"model", "mode", "temp", "fan", "swing"};
+    for (const char* field : FIELDS) {
+        if (!patch[field].isNull() && !patch[field].is<int>() && !patch[field].is<bool>()) {
+            sendServerTiming(t1 - t0, micros() - t1, 0, 0, 0);
+            server.send(400, "text/plain", "Fields must be integers (swing may be boolean)");
+            return;
+        }
+    }
+    
+    if (!patch["model"].isNull()) {
+        int model = patch["model"].as<int>();
+        if (model < 0 || model >= AC_MODEL_COUNT) {
+            sendServerTiming(t1 - t0, micros() - t1, 0, 0, 0);
+            server.send(400, "text/plain", "Unknown model");
+            return;
+        }
+        state.model = model;
+    }
+    if (!patch["mode"].isNull()) state.mode = patch["mode"].as<int>();
+    if (!patch["temp"].isNull()) state.temp = patch["temp"].as<int>();
+    if (!patch["fan"].isNull()) state.fan = patch["fan"].as<int>();
+    if (!patch["swing"].isNull()) state.swing = patch["swing"].is<bool>() ? patch["swing"].as<bool>() : patch["swing"].as<int>() == 1;
+    
+    ACState requested = state;
+    uint8_t adjusted = ACController::validate(state.mode, state.temp, state.fan);
+    uint32_t t2 = micros();
+    
+    // Admit, then transmit right away if nothing is ahead of us
+    uint32_t retryAfter = 0;
+    uint32_t id = 0;
+    AdmitResult result = submitCommand(HISTORY_SOURCE_API, (uint32_t)server.client().remoteIP(), state.model,
+                                       state.mode, state.temp, state.fan, state.swing, retryAfter, &id);
+    if (result != ADMIT_OK) {
+        sendServerTiming(t1 - t0, t2 - t1, 0, 0, 0);
+        server.sendHeader("Retry-After", String(retryAfter));
+        server.send(429, "text/plain", result == ADMIT_RATE_LIMITED ? "Too many commands from this client"
+                                                                     : "Command queue full");
+        return;
+    }
+    
+    // A rejected request must not leave a new model behind
+    if (state.model != currentACModel) {
+        currentACModel = state.model;
+        setConfigValue("acmodel", currentACModel);
+        Serial.printf("AC Model changed to: %d (%s)\n", currentACModel, AC_MODEL_NAMES[currentACModel]);
+    }
+    
+    // Response: the state, whether it was sent, and any clamping applied
+    JsonObject effective = response["state"].to<JsonObject>();
+    response["sent"] = false;
+    JsonArray changes = response["adjusted"].to<JsonArray>();
+    if (adjusted & AC_ADJUST_MODE) {
+        JsonObject change = changes.add<JsonObject>();
+        change["field"] = "mode";
+        change["requested"] = requested.mode;
+        change["applied"] = state.mode;
+    }
+    if (adjusted & AC_ADJUST_TEMP) {
+        JsonObject change = changes.add<JsonObject>();
+        change["field"] = "temp";
+        change["requested"] = requested.temp;
+        change["applied"] = state.temp;
+    }
+    if (adjusted & AC_ADJUST_FAN) {
+        JsonObject change = changes.add<JsonObject>();
+        change["field"] = "fan";
+        change["requested"] = requested.fan;
+        change["applied"] = state.fan;
+    }
+    
+    // Commands ahead of ours are left to processCommandQueue(), one per loop
+    // pass, so the web server is never blocked behind them
+    QueuedCommand command;
+    if (!commandScheduler.takeIfNext(id, command, millis())) {
+        effective["model"] = state.model;
+        effective["model_name"] = AC_MODEL_NAMES[state.model];
+        effective["mode"] = state.mode;
+        effective["temp"] = state.temp;
+        effective["fan"] = state.fan;
+        effective["swing"] = state.swing;
+        response["queued"] = id;
+        
+        String json;
+        json.reserve(measureJson(response) + 1);
+        serializeJson(response, json);
+        sendServerTiming(t1 - t0, t2 - t1, 0, 0, 0);
+        server.send(202, "application/json", json);
+        return;
+    }
+    uint32_t queueWait = micros() - t2;
+    bool sent = executeQueued(command);
+    const ACTiming& timing = acController.lastTiming();
+    
+    const ACState& applied = acController.lastState();
+    effective["model"] = applied.model;
+    effective["model_name"] = AC_MODEL_NAMES[applied.model];
+    effective["mode"] = applied.mode;
+    effective["temp"] = applied.temp;
+    effective["fan"] = applied.fan;
+    effective["swing"] = applied.swing;
+    response["sent"] = sent;
+    
+    String json;
+    json.reserve(measureJson(response) + 1);
+    serializeJson(response, json);
+    sendServerTiming(t1 - t0, t2 - t1, timing.encodeUs, queueWait, timing.transmitUs);
+    server.send(sent ? 200 : 500, "application/json", json);
+}
+
+// Server-Timing header (durations in milliseconds) for /api/ac responses
+void sendServerTiming(uint32_t parseUs, uint32_t validateUs, uint32_t encodeUs, uint32_t queueUs, uint32_t transmitUs) {
+    char header[160];
+    snprintf(header, sizeof(header),
+             "parse;dur=%.2f, validate;dur=%.2f, encode;dur=%.2f, queue;dur=%.2f, transmit;dur=%.2f",
+             parseUs / 1000.0f, validateUs / 1000.0f, encodeUs / 1000.0f, queueUs / 1000.0f, transmitUs / 1000.0f);
+    server.sendHeader("Server-Timing", header);
+}
+
+void recordCommand(HistorySource source, bool sent) {
+    const ACState& state = acController.lastState();
+    stateHistory.append(source, state.model, state.mode, state.temp, state.fan, state.swing, sent);
+    if (sent) {
+        shadowSource = source;
+        shadowUpdatedAt = StateHistory::now();
+    }
+    
+    // Any other command means someone is controlling the unit by hand;
+    // the thermostat steps aside instead of fighting them
+    if (sent && source != HISTORY_SOURCE_THERMOSTAT && thermostat.enabled()) {
+        thermostat.manualOverride();
+        saveThermostat();
+        // A start or stop it queued before the override must not follow it
+        cancelQueued(HISTORY_SOURCE_THERMOSTAT);
+        Serial.println("Manual command received, thermostat switched off");
+    }
+    
+    // Likewise a running scene: its delayed steps must not undo the change
+    // (e.g. the sleep scene switching the unit back on after a manual off)
+    if (sent && source != HISTORY_SOURCE_SCENE && sceneStore.running() != nullptr) {
+        Serial.printf("Manual command received, scene '%s' cancelled\n", sceneStore.running());
+        sceneStore.stop();
+        cancelQueued(HISTORY_SOURCE_SCENE);
+    }
+}
+
+// Drop commands from `source` that are still waiting for the transmitter
+void cancelQueued(HistorySource source) {
+    QueuedCommand command;
+    while (commandScheduler.cancel(source, command)) {
+        stateHistory.append(source, command.model < 0 ? currentACModel : command.model,
+                            command.mode, command.temp, command.fan, command.swing, false);
+    }
+}
+
+void processReceivedStates() {
+    ReceivedState received;
+    while (irReceiver.poll(received)) {
+        applyReceivedState(received);
+    }
+}
+
+// A physical remote changed the unit: adopt the decoded state as the shadow
+// state so clients stop issuing corrective commands
+void applyReceivedState(const ReceivedState& received) {
+    // Our own transmission reflected into the receiver
+    if ((int32_t)(received.receivedAt - lastTransmitEnd) < IR_RECEIVE_ECHO_GUARD_MS) {
+        irReceiver.countOutcome(false);
+        return;
+    }
+    
+    // Frames for another protocol come from a neighbouring unit's remote
+    if (received.protocol != ACController::protocolFor(currentACModel)) {
+        irReceiver.countOutcome(false);
+        return;
+    }
+    
+    ACState state = acController.lastState();
+    state.model = currentACModel;
+    state.mode = received.mode;
+    if (received.temp >= AC_TEMP_MIN && received.temp <= AC_TEMP_MAX) state.temp = received.temp;
+    if (received.fan >= AC_FAN_MIN && received.fan <= AC_FAN_MAX) state.fan = received.fan;
+    state.swing = received.swing;
+    
+    const ACState& shadow = acController.lastState();
+    if (state.model == shadow.model && state.mode == shadow.mode && state.temp == shadow.temp &&
+        state.fan == shadow.fan && state.swing == shadow.swing) {
+        irReceiver.countOutcome(false);
+        return;
+    }
+    
+    acController.adoptState(state);
+    irReceiver.countOutcome(true);
+    recordCommand(HISTORY_SOURCE_REMOTE, true);
+    Serial.printf("Remote changed state: Mode=%d, Temp=%d, Fan=%d, Swing=%s\n",
+                  state.mode, state.temp, state.fan, state.swing ? "ON" : "OFF");
+}
+
+void historyHandler() {
+    TelemetryScope scope("history");
+    
+    static const char* MODE_KEYS[AC_MODE_MAX + 1] = {"off", "cool", "heat", "fan", "dry"};
+    
+    uint32_t now = StateHistory::now();
+    uint32_t to = server.hasArg("to") ? strtoul(server.arg("to").c_str(), nullptr, 10) : now;
+    uint32_t from = server.hasArg("from") ? strtoul(server.arg("from").c_str(), nullptr, 10) : (to > 86400 ? to - 86400 : 0);
+    uint32_t bucket = server.hasArg("bucket") ? strtoul(server.arg("bucket").c_str(), nullptr, 10) : 3600;
+    
+    size_t needed = StateHistory::bucketCount(from, to, bucket);
+    if (needed == 0 || needed > HISTORY_MAX_BUCKETS) {
+        server.send(400, "text/plain", "Invalid range: need from < to, bucket <= to - from and at most " + String(HISTORY_MAX_BUCKETS) + " buckets");
+        return;
+    }
+    
+    // Bucket scratch space lives in the request arena like the JSON document
+    // (heap fallback if the arena is exhausted, released below)
+    HistoryBucket* buckets = static_cast<HistoryBucket*>(requestArena.allocate(needed * sizeof(HistoryBucket)));
+    if (buckets == nullptr) {
+        server.send(503, "text/plain", "Out of memory");
+        return;
+    }
+    size_t count = stateHistory.aggregate(from, to, bucket, now, buckets, needed);
+    
+    JsonDocument doc(&requestArena);
+    doc["now"] = now;
+    doc["from"] = from;
+    doc["to"] = to;
+    doc["bucket"] = bucket;
+    doc["records"] = stateHistory.size();
+    
+    uint32_t totalRuntime[AC_MODE_MAX + 1] = {0};
+    uint32_t totalCommands = 0;
+    uint32_t totalOn = 0;
+    double totalSetpoint = 0;
+    
+    JsonArray list = doc["buckets"].to<JsonArray>();
+    for (size_t i = 0; i < count; i++) {
+        const HistoryBucket& b = buckets[i];
+        JsonObject entry = list.add<JsonObject>();
+        entry["start"] = b.start;
+        entry["commands"] = b.commands;
+        entry["suppressed"] = b.suppressed;
+        JsonObject runtime = entry["runtime"].to<JsonObject>();
+        for (int m = 0; m <= AC_MODE_MAX; m++) {
+            runtime[MODE_KEYS[m]] = b.runtime[m];
+            totalRuntime[m] += b.runtime[m];
+        }
+        if (b.onSeconds > 0) {
+            entry["avg_setpoint"] = (float)b.setpointSeconds / b.onSeconds;
+        } else {
+            entry["avg_setpoint"] = nullptr;
+        }
+        totalCommands += b.commands;
+        totalOn += b.onSeconds;
+        totalSetpoint += b.setpointSeconds;
+    }
+    requestArena.deallocate(buckets);
+    
+    JsonObject totals = doc["totals"].to<JsonObject>();
+    totals["commands"] = totalCommands;
+    JsonObject runtime = totals["runtime"].to<JsonObject>();
+    for (int m = 0; m <= AC_MODE_MAX; m++) {
+        runtime[MODE_KEYS[m]] = totalRuntime[m];
+    }
+    if (totalOn > 0) {
+        totals["avg_setpoint"] = totalSetpoint / totalOn;
+    } else {
+        totals["avg_setpoint"] = nullptr;
+    }
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
+
+void sendGroupResult(const char* group, const GroupResult& result) {
+    JsonDocument doc(&requestArena);
+    
+    doc["group"] = group;
+    doc["seq"] = result.seq;
+    doc["local"]["member"] = result.localMember;
+    doc["local"]["success"] = result.localSuccess;
+    doc["ack_count"] = result.ackCount;
+    
+    JsonArray acks = doc["acks"].to<JsonArray>();
+    for (int i = 0; i < result.ackCount; i++) {
+        char id[9];
+        char ip[16];
+        const GroupAck& ack = result.acks[i];
+        snprintf(id, sizeof(id), "%08x", ack.deviceId);
+        snprintf(ip, sizeof(ip), "%u.%u.%u.%u", ack.ip[0], ack.ip[1], ack.ip[2], ack.ip[3]);
+        JsonObject entry = acks.add<JsonObject>();
+        entry["id"] = id;
+        entry["ip"] = ip;
+        entry["success"] = ack.success;
+    }
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
+
+// /scene?name=X runs a scene, POST /scene?name=X stores one,
+// /scene?delete=X removes one, /scene?stop=1 cancels the running one,
+// and a bare /scene lists them
+void sceneHandler() {
+    TelemetryScope scope("scene");
+    
+    if (server.hasArg("delete")) {
+        if (!sceneStore.remove(server.arg("delete").c_str())) {
+            server.send(404, "text/plain", "Unknown scene");
+            return;
+        }
+        prerenderScenes();
+        server.send(200, "text/plain", "Scene deleted");
+        return;
+    }
+    
+    if (server.hasArg("stop")) {
+        sceneStore.stop();
+        server.send(200, "text/plain", "Scene stopped");
+        return;
+    }
+    
+    if (server.hasArg("name")) {
+        const String& name = server.arg("name");
+        if (server.method() == HTTP_POST) {
+            saveScene(name.c_str());
+            return;
+        }
+        if (!sceneStore.trigger(name.c_str())) {
+            server.send(404, "text/plain", "Unknown scene");
+            return;
+        }
+        server.send(202, "text/plain", "Scene started");
+        return;
+    }
+    
+    sendSceneList();
+}
+
+void saveScene(const char* name) {
+    if (!SceneStore::validName(name)) {
+        server.send(400, "text/plain", "Scene names are 1-" + String(SCENE_NAME_MAX) + " characters of A-Z, a-z, 0-9, _ or -");
+        return;
+    }
+    
+    JsonDocument doc(&requestArena);
+    const String& body = server.arg("plain");
+    DeserializationError error = deserializeJson(doc, body.c_str(), body.length());
+    JsonArray steps = doc["steps"].as<JsonArray>();
+    if (error || steps.isNull() || steps.size() == 0 || steps.size() > SCENE_MAX_STEPS) {
+        server.send(400, "text/plain", "Body must be {\"steps\": [...]} with 1-" + String(SCENE_MAX_STEPS) + " steps");
+        return;
+    }
+    
+    Scene scene;
+    memset(&scene, 0, sizeof(scene));
+    strcpy(scene.name, name);
+    
+    char message[64];
+    for (JsonObject entry : steps) {
+        int index = scene.stepCount + 1;
+        int mode = entry["mode"] | -1;
+        int temp = entry["temp"] | (mode == AC_MODE_OFF ? 24 : -1);
+        int fan = entry["fan"] | AC_FAN_MIN;
+        int model = entry["model"] | -1;
+        bool swing = entry["swing"].is<bool>() ? entry["swing"].as<bool>() : (entry["swing"] | 0) == 1;
+        long delayMs = entry["delay_ms"] | 0L;
+        const char* zone = entry["zone"] | "";
+        
+        const char* problem = nullptr;
+        if (mode < AC_MODE_MIN || mode > AC_MODE_MAX) problem = "mode";
+        else if (temp < AC_TEMP_MIN || temp > AC_TEMP_MAX) problem = "temp";
+        else if (fan < AC_FAN_MIN || fan > AC_FAN_MAX) problem = "fan";
+        else if (model < -1 || model >= AC_MODEL_COUNT) problem = "model";
+        else if (delayMs < 0 || delayMs > SCENE_MAX_DELAY_MS) problem = "delay_ms";
+        else if (strlen(zone) > GROUP_NAME_MAX) problem = "zone";
+        if (problem != nullptr) {
+            snprintf(message, sizeof(message), "Step %d: missing or invalid %s", index, problem);
+            server.send(400, "text/plain", message);
+            return;
+        }
+        
+        SceneStep& step = scene.steps[scene.stepCount++];
+        step.model = model;
+        step.mode = mode;
+        step.temp = temp;
+        step.fan = fan;
+        step.swing = swing ? 1 : 0;
+        step.delayMs = delayMs;
+        strcpy(step.zone, zone);
+    }
+    
+    if (!sceneStore.save(scene)) {
+        server.send(507, "text/plain", "Scene limit reached or storage unavailable");
+        return;
+    }
+    
+    // Render now so the first trigger is already a cache hit
+    size_t pinned = prerenderScenes();
+    Serial.printf("Scene '%s' saved with %u step(s)\n", name, scene.stepCount);
+    
+    JsonDocument response(&requestArena);
+    response["scene"] = name;
+    response["steps"] = scene.stepCount;
+    response["pinned_steps"] = pinned;
+    
+    String json;
+    json.reserve(measureJson(response) + 1);
+    serializeJson(response, json);
+    server.send(200, "application/json", json);
+}
+
+void sendSceneList() {
+    JsonDocument doc(&requestArena);
+    
+    const char* running = sceneStore.running();
+    if (running != nullptr) {
+        doc["running"] = running;
+        doc["next_step"] = sceneStore.runningStep();
+    } else {
+        doc["running"] = nullptr;
+    }
+    doc["triggers"] = sceneStore.triggers();
+    doc["udp_port"] = SCENE_UDP_PORT;
+    
+    JsonArray scenes = doc["scenes"].to<JsonArray>();
+    for (size_t i = 0; i < sceneStore.count(); i++) {
+        const Scene& scene = sceneStore.at(i);
+        JsonObject entry = scenes.add<JsonObject>();
+        entry["name"] = scene.name;
+        JsonArray steps = entry["steps"].to<JsonArray>();
+        for (uint8_t s = 0; s < scene.stepCount; s++) {
+            const SceneStep& step = scene.steps[s];
+            JsonObject item = steps.add<JsonObject>();
+            if (step.model >= 0) item["model"] = step.model;
+            item["mode"] = step.mode;
+            item["temp"] = step.temp;
+            item["fan"] = step.fan;
+            item["swing"] = step.swing == 1;
+            item["delay_ms"] = step.delayMs;
+            if (step.zone[0] != '\0') item["zone"] = step.zone;
+        }
+    }
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
+
+// What the previous session was doing when it ended, next to the live
+// counters of this one, so resets and slowdowns can be correlated
+void diagnosticsHandler() {
+    static const char* SOURCES[] = {"none", "rtc", "nvs"};
+    
+    JsonDocument doc(&requestArena);
+    doc["boot_count"] = telemetry.bootCount();
+    doc["reset_reason"] = Telemetry::resetReasonName(telemetry.current().resetReason);
+    doc["lifetime_min_free_heap"] = telemetry.lifetimeMinFreeHeap();
+    
+    addSessionJSON(doc["current"].to<JsonObject>(), telemetry.current());
+    
+    doc["previous_source"] = SOURCES[telemetry.previousSource()];
+    if (telemetry.previousSource() != TELEMETRY_SOURCE_NONE) {
+        JsonObject previous = doc["previous"].to<JsonObject>();
+        addSessionJSON(previous, telemetry.previous());
+        // A handler still marked active means the reset interrupted it
+        previous["interrupted_handler"] = telemetry.previous().activeHandler[0] != '\0'
+                                              ? telemetry.previous().activeHandler : nullptr;
+    } else {
+        doc["previous"] = nullptr;
+    }
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
+
+void addSessionJSON(JsonObject out, const TelemetrySession& session) {
+    out["uptime_s"] = session.uptimeS;
+    out["started_by"] = Telemetry::resetReasonName(session.resetReason);
+    out["min_free_heap"] = session.minFreeHeap;
+    out["max_loop_stall_ms"] = session.maxLoopStallMs;
+    out["max_loop_stall_after"] = session.stallHandler;
+    
+    // Oldest first; each point is the worst value over 15 minutes
+    JsonArray trend = out["largest_free_block"].to<JsonArray>();
+    for (uint8_t i = 0; i < session.trendCount; i++) {
+        uint8_t index = (session.trendHead + TELEMETRY_TREND_POINTS - session.trendCount + i) % TELEMETRY_TREND_POINTS;
+        trend.add(session.largestBlock[index]);
+    }
+    
+    out["wifi"]["outages"] = session.wifiOutages;
+    out["wifi"]["outage_ms"] = session.wifiOutageMs;
+    out["commands"]["sent"] = session.commandsSent;
+    out["commands"]["failed"] = session.commandsFailed;
+    out["commands"]["rejected"] = session.commandsRejected;
+    
+    JsonArray handlers = out["handlers"].to<JsonArray>();
+    for (uint8_t i = 0; i < session.handlerCount; i++) {
+        uint8_t index = (session.handlerHead + TELEMETRY_HANDLER_HISTORY - session.handlerCount + i) % TELEMETRY_HANDLER_HISTORY;
+        const TelemetryHandlerRecord& record = session.handlers[index];
+        JsonObject entry = handlers.add<JsonObject>();
+        entry["name"] = record.name;
+        entry["ms"] = record.ms;
+        entry["at_s"] = record.at;
+    }
+}
+
+void otaHandler() {
+    TelemetryScope scope("ota");
+    
+    // Starting or aborting an update takes the OTA secret set on the
+    // configuration page, as the password of user "ota" (HTTP Basic auth)
+    if (server.method() == HTTP_POST || server.method() == HTTP_DELETE) {
+        String secret = getConfigValue("ota_secret", "");
+        if (secret.length() == 0) {
+            server.send(403, "text/plain", "Set an OTA secret on the configuration page first");
+            return;
+        }
+        if (!server.authenticate("ota", secret.c_str())) {
+            server.requestAuthentication();
+            return;
+        }
+    }
+    
+    if (server.method() == HTTP_DELETE) {
+        otaUpdater.abort();
+        sendOtaStatus(200);
+        return;
+    }
+    if (server.method() != HTTP_POST) {
+        sendOtaStatus(200);
+        return;
+    }
+    
+    JsonDocument request(&requestArena);
+    const String& body = server.arg("plain");
+    DeserializationError error = deserializeJson(request, body.c_str(), body.length());
+    if (error || !request.is<JsonObject>() || !request["url"].is<const char*>() || !request["sha256"].is<const char*>()) {
+        server.send(400, "text/plain", "Body must be a JSON object with url and sha256");
+        return;
+    }
+    
+    // SHA-256 of the uncompressed image, as 64 hex digits
+    const char* hex = request["sha256"];
+    uint8_t sha256[32];
+    if (strlen(hex) != 64) {
+        server.send(400, "text/plain", "sha256 must be 64 hex digits");
+        return;
+    }
+    for (int i = 0; i < 32; i++) {
+        char byte[3] = {hex[i * 2], hex[i * 2 + 1], '\0'};
+        char* end;
+        sha256[i] = strtoul(byte, &end, 16);
+        if (*end != '\0') {
+            server.send(400, "text/plain", "sha256 must be 64 hex digits");
+            return;
+        }
+    }
+    
+    static const char* FORMATS[] = {"auto", "raw", "gzip", "heatshrink"};
+    const char* formatName = request["format"] | "auto";
+    int format = -1;
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(formatName, FORMATS[i]) == 0) format = i;
+    }
+    if (format < 0) {
+        server.send(400, "text/plain", "format must be auto, raw, gzip or heatshrink");
+        return;
+    }
+    
+    if (!otaUpdater.start(request["url"], sha256, (OtaFormat)format,
+                          request["window"] | OTA_HEATSHRINK_WINDOW_BITS,
+                          request["lookahead"] | OTA_HEATSHRINK_LOOKAHEAD_BITS,
+                          request["restart"] | true)) {
+        OtaState state = otaUpdater.state();
+        server.send(state == OTA_DOWNLOADING || state == OTA_DONE ? 409 : 400, "text/plain", otaUpdater.error());
+        return;
+    }
+    sendOtaStatus(202);
+}
+
+void sendOtaStatus(int code) {
+    JsonDocument doc(&requestArena);
+    OtaState state = otaUpdater.state();
+    doc["state"] = OtaUpdater::stateName(state);
+    doc["running_partition"] = esp_ota_get_running_partition()->label;
+    if (otaUpdater.error()[0] != '\0') doc["error"] = otaUpdater.error();
+    
+    if (state != OTA_IDLE) {
+        uint32_t elapsed = otaUpdater.elapsedMs();
+        uint32_t flashMs = otaUpdater.flashMs();
+        doc["url"] = otaUpdater.url();
+        doc["format"] = OtaUpdater::formatName(otaUpdater.format());
+        doc["received"] = otaUpdater.received();
+        doc["total"] = otaUpdater.total();
+        doc["progress"] = otaUpdater.total() > 0 ? roundf(otaUpdater.received() * 1000.0f / otaUpdater.total()) / 10 : 0;
+        doc["written"] = otaUpdater.written();
+        doc["resumes"] = otaUpdater.resumes();
+        doc["elapsed_ms"] = elapsed;
+        doc["flash_ms"] = flashMs;
+        // Throughput in KiB/s: compressed bytes over wall time, image bytes over flash write time
+        doc["download_kib_s"] = elapsed > 0 ? roundf(otaUpdater.received() * 10000.0f / 1024 / elapsed) / 10 : 0;
+        doc["flash_kib_s"] = flashMs > 0 ? roundf(otaUpdater.written() * 10000.0f / 1024 / flashMs) / 10 : 0;
+    }
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(code, "application/json", json);
+}
+
+// ===== THERMOSTAT =====
+
+void thermostatHandler() {
+    TelemetryScope scope("thermostat");
+    
+    if (server.method() != HTTP_POST) {
+        sendThermostatStatus();
+        return;
+    }
+    
+    JsonDocument patch(&requestArena);
+    const String& body = server.arg("plain");
+    DeserializationError error = deserializeJson(patch, body.c_str(), body.length());
+    if (error || !patch.is<JsonObject>()) {
+        server.send(400, "text/plain", "Body must be a JSON object");
+        return;
+    }
+    
+    static const char* NUMBERS[] = {"temperature", "target", "hysteresis", "min_on_s", "min_off_s", "fan"};
+    for (const char* field : NUMBERS) {
+        if (!patch[field].isNull() && !patch[field].is<float>()) {
+            server.send(400, "text/plain", "temperature, target, hysteresis, min_on_s, min_off_s and fan must be numbers");
+            return;
+        }
+    }
+    
+    // A room temperature reading, in degrees C
+    if (!patch["temperature"].isNull()) {
+        float celsius = patch["temperature"].as<float>();
+        if (celsius < -40 || celsius > 80) {
+            server.send(400, "text/plain", "temperature out of range");
+            return;
+        }
+        thermostat.reportTemperature((int16_t)lroundf(celsius * 10), millis());
+        roomReadingLocal = false;
+    }
+    
+    // Range-check the raw values: converted first, they could wrap back into
+    // range (min_on_s 4294968 becomes 704 ms)
+    struct Range { const char* field; double min; double max; };
+    static const Range RANGES[] = {
+        {"target", AC_TEMP_MIN, AC_TEMP_MAX},
+        {"hysteresis", 0.1, THERMOSTAT_MAX_HYSTERESIS / 10.0},
+        {"min_on_s", 0, THERMOSTAT_MAX_MIN_TIME_MS / 1000},
+        {"min_off_s", 0, THERMOSTAT_MAX_MIN_TIME_MS / 1000},
+        {"fan", AC_FAN_MIN, AC_FAN_MAX}
+    };
+    for (const Range& range : RANGES) {
+        if (patch[range.field].isNull()) continue;
+        double value = patch[range.field].as<double>();
+        if (!(value >= range.min && value <= range.max)) {
+            server.send(400, "text/plain", "Settings out of range (see API documentation)");
+            return;
+        }
+    }
+    
+    // Settings: omitted fields keep their current values
+    ThermostatSettings settings = thermostat.settings();
+    if (!patch["mode"].isNull()) {
+        static const char* MODES[] = {"off", "cool", "heat"};
+        const char* mode = patch["mode"] | "";
+        int index = -1;
+        for (int i = 0; i < 3; i++) {
+            if (strcmp(mode, MODES[i]) == 0) index = i;
+        }
+        if (index < 0) {
+            server.send(400, "text/plain", "mode must be off, cool or heat");
+            return;
+        }
+        settings.mode = index;
+    }
+    if (!patch["target"].isNull()) settings.target = lroundf(patch["target"].as<float>() * 10);
+    if (!patch["hysteresis"].isNull()) settings.hysteresis = lroundf(patch["hysteresis"].as<float>() * 10);
+    if (!patch["min_on_s"].isNull()) settings.minOnMs = patch["min_on_s"].as<uint32_t>() * 1000;
+    if (!patch["min_off_s"].isNull()) settings.minOffMs = patch["min_off_s"].as<uint32_t>() * 1000;
+    if (!patch["fan"].isNull()) settings.fan = patch["fan"].as<int>();
+    if (!patch["swing"].isNull()) settings.swing = patch["swing"].is<bool>() ? patch["swing"].as<bool>() : patch["swing"].as<int>() == 1;
+    
+    if (!Thermostat::validSettings(settings)) {
+        server.send(400, "text/plain", "Settings out of range (see API documentation)");
+        return;
+    }
+    if (!Thermostat::sameSettings(settings, thermostat.settings())) {
+        thermostat.configure(settings, unitState());
+        saveThermostat();
+    }
+    
+    // React now rather than on the next loop pass
+    runThermostat();
+    sendThermostatStatus();
+}
+
+void sendThermostatStatus() {
+    static const char* MODES[] = {"off", "cool", "heat"};
+    const ThermostatSettings& settings = thermostat.settings();
+    uint32_t now = millis();
+    
+    JsonDocument doc(&requestArena);
+    doc["mode"] = MODES[settings.mode];
+    doc["target"] = settings.target / 10.0f;
+    doc["hysteresis"] = settings.hysteresis / 10.0f;
+    doc["min_on_s"] = settings.minOnMs / 1000;
+    doc["min_off_s"] = settings.minOffMs / 1000;
+    doc["fan"] = settings.fan;
+    doc["swing"] = settings.swing;
+    
+    if (thermostat.hasReading(now)) {
+        doc["temperature"] = thermostat.temperature() / 10.0f;
+        doc["reading_age_s"] = thermostat.readingAgeMs(now) / 1000;
+        doc["reading_source"] = roomReadingLocal ? "sensor" : "push";
+    } else {
+        doc["temperature"] = nullptr;
+    }
+    doc["running"] = thermostat.running();
+    doc["hold_remaining_s"] = (thermostat.holdRemainingMs(now) + 999) / 1000;
+    
+    JsonObject stats = doc["stats"].to<JsonObject>();
+    stats["readings"] = thermostat.readings();
+    stats["commands"] = thermostat.commands();
+    stats["cycles"] = thermostat.cycles();
+    stats["held"] = thermostat.held();
+    
+    String json;
+    json.reserve(measureJson(doc) + 1);
+    serializeJson(doc, json);
+    server.send(200, "application/json", json);
+}
 
+void loadThermostat() {
+    ThermostatSettings settings;
+    if (preferences.getBytes("thermostat", &settings, sizeof(settings)) != sizeof(settings) ||
+        !Thermostat::validSettings(settings)) {
+        settings = Thermostat::defaults();
+    }
+    thermostat.configure(settings, unitState());
+    if (thermostat.enabled()) {
+        Serial.printf("Thermostat: %s to %.1f C\n", settings.mode == THERMOSTAT_HEAT ? "heat" : "cool", settings.target / 10.0f);
+    }
+}
 
+void saveThermostat() {
+    preferences.putBytes("thermostat", &thermostat.settings(), sizeof(ThermostatSettings));
+}
+
+// What the unit is doing now, according to the shadow state
+ThermostatCommand unitState() {
+    const ACState& state = acController.lastState();
+    ThermostatCommand unit;
+    unit.mode = state.mode;
+    unit.temp = state.temp;
+    unit.fan = state.fan;
+    unit.swing = state.swing;
+    return unit;
+}
 
+void runThermostat() {
+    ThermostatCommand command;
+    if (!thermostat.update(millis(), command)) return;
+    
+    // Internal client: not rate limited. If the queue is full the same
+    // command comes back on the next pass.
+    uint32_t retryAfter = 0;
+    if (submitCommand(HISTORY_SOURCE_THERMOSTAT, 0, currentACModel, command.mode, command.temp,
+                      command.fan, command.swing, retryAfter) != ADMIT_OK) {
+        return;
+    }
+    thermostat.markIssued(command, millis());
+    Serial.printf("Thermostat: room %.1f C, unit %s\n", thermostat.temperature() / 10.0f,
+                  command.mode == AC_MODE_OFF ? "off" : "on");
+}
+
+// NTC divider on an ADC1 pin: series resistor to 3.3 V, thermistor to GND
+void sampleRoomSensor() {
+    if (THERMOSTAT_SENSOR_PIN < 0 || millis() - lastSensorSample < THERMOSTAT_SENSOR_INTERVAL_MS) {
+        return;
+    }
+    lastSensorSample = millis();
+    
+    uint32_t mv = 0;
+    for (int i = 0; i < THERMOSTAT_SENSOR_SAMPLES; i++) {
+        mv += analogReadMilliVolts(THERMOSTAT_SENSOR_PIN);
+    }
+    mv /= THERMOSTAT_SENSOR_SAMPLES;
+    if (mv < 50 || mv > 3250) {
+        return;   // Open or shorted sensor; the reading goes stale and the unit stops
+    }
+    
+    float ohms = THERMOSTAT_NTC_SERIES_OHMS * (float)mv / (3300 - mv);
+    float kelvin = 1.0f / (1.0f / 298.15f + logf(ohms / THERMOSTAT_NTC_NOMINAL_OHMS) / THERMOSTAT_NTC_BETA);
+    thermostat.reportTemperature((int16_t)lroundf((kelvin - 273.15f) * 10), millis());
+    roomReadingLocal = true;
+}
 
 void resetHandler() {
+    TelemetryScope scope("reset");
+    
     if (server.hasArg("erase") && server.arg("erase") == "1") {
         Serial.println("Erasing WiFi settings...");
         wifiManager.resetSettings();
         server.send(200, "text/plain", "WiFi settings erased. Device will restart.");
+        stateHistory.checkpoint();
+        telemetry.checkpoint();
         delay(1000);
         ESP.restart();
     } else if (server.hasArg("restart") && server.arg("restart") == "1") {
         Serial.println("Restarting device...");
         server.send(200, "text/plain", "Device restarting...");
+        stateHistory.checkpoint();
+        telemetry.checkpoint();
         delay(1000);
         ESP.restart();
     } else {
@@ -219,6 +1387,62 @@ void resetHandler() {
 
 
 
+void warmPulseCache() {
+    uint32_t keys[PULSE_CACHE_WARM_COUNT];
+    size_t bytes = preferences.getBytes("pcwarm", keys, sizeof(keys));
+    size_t count = bytes / sizeof(uint32_t);
+    
+    unsigned long start = millis();
+    size_t warmed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (acController.warmCache(keys[i])) warmed++;
+    }
+    if (count > 0) {
+        Serial.printf("Pulse cache warmed with %u/%u states in %lu ms\n", warmed, count, millis() - start);
+    }
+    acController.cache().takeDirty();
+}
+
+void savePulseCacheWarmList() {
+    if (!acController.cache().takeDirty()) return;
+    
+    uint32_t keys[PULSE_CACHE_WARM_COUNT];
+    size_t count = acController.cache().hotKeys(keys, PULSE_CACHE_WARM_COUNT);
+    preferences.putBytes("pcwarm", keys, count * sizeof(uint32_t));
+}
+
+// Render every scene step that transmits on this device into the pulse
+// cache and pin it, so triggers replay stored trains instead of encoding.
+// Returns how many steps are pinned.
+size_t prerenderScenes() {
+    TelemetryScope scope("prerender");
+    
+    PulseCache& cache = acController.cache();
+    cache.unpinAll();
+    sceneRenderModel = currentACModel;
+    
+    unsigned long start = millis();
+    size_t local = 0;
+    size_t pinned = 0;
+    for (size_t i = 0; i < sceneStore.count(); i++) {
+        const Scene& scene = sceneStore.at(i);
+        for (uint8_t s = 0; s < scene.stepCount; s++) {
+            const SceneStep& step = scene.steps[s];
+            if (step.zone[0] != '\0' && !groupSync.isMember(step.zone)) continue;
+            local++;
+            
+            // Rendering blocks the loop; anything past the pin budget would
+            // just be evicted again, so it is left to render on first use
+            if (cache.pinned() >= PULSE_CACHE_MAX_PINNED) continue;
+            int model = step.model >= 0 ? step.model : currentACModel;
+            uint32_t key = ACController::cacheKey(model, step.mode, step.temp, step.fan, step.swing == 1);
+            if (acController.warmCache(key) && cache.pin(key)) pinned++;
+        }
+    }
+    Serial.printf("Scenes pre-rendered: %u/%u steps pinned in %lu ms\n", pinned, local, millis() - start);
+    return pinned;
+}
+
 void startConfigPortal() {
     Serial.println("Starting WiFi configuration portal...");
     Serial.println("Connect to WiFi network: " + String(WIFI_AP_SSID));
@@ -238,8 +1462,10 @@ void startConfigPortal() {
 
 
 void handleConfigSave(const String& data) {
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, data);
+    TelemetryScope scope("config_save");
+    
+    JsonDocument doc(&requestArena);
+    DeserializationError error = deserializeJson(doc, data.c_str(), data.length());
     
     if (error) {
         Serial.println("Failed to parse JSON");
@@ -251,42 +1477,46 @@ void handleConfigSave(const String& data) {
         int acModel = doc["acmodel"].as<int>();
         if (acModel >= 0 && acModel < AC_MODEL_COUNT) {
             currentACModel = acModel;
-            setConfigValue("acmodel", String(currentACModel));
+            setConfigValue("acmodel", currentACModel);
             Serial.printf("Saved AC Model: %d (%s)\n", currentACModel, AC_MODEL_NAMES[currentACModel]);
         }
     }
     
     // Save device settings
-    if (doc["hostname"].is<String>()) {
-        String hostname = doc["hostname"].as<String>();
+    if (doc["hostname"].is<const char*>()) {
+        const char* hostname = doc["hostname"].as<const char*>();
         setConfigValue("hostname", hostname);
-        Serial.println("Saved hostname: " + hostname);
+        Serial.printf("Saved hostname: %s\n", hostname);
     }
     
-    if (doc["ap_ssid"].is<String>()) {
-        String apSSID = doc["ap_ssid"].as<String>();
+    if (doc["ap_ssid"].is<const char*>()) {
+        const char* apSSID = doc["ap_ssid"].as<const char*>();
         setConfigValue("ap_ssid", apSSID);
-        Serial.println("Saved AP SSID: " + apSSID);
+        Serial.printf("Saved AP SSID: %s\n", apSSID);
     }
     
-    if (doc["ap_password"].is<String>()) {
-        String apPassword = doc["ap_password"].as<String>();
-        setConfigValue("ap_password", apPassword);
+    if (doc["ap_password"].is<const char*>()) {
+        setConfigValue("ap_password", doc["ap_password"].as<const char*>());
         Serial.println("Saved AP password: [HIDDEN]");
     }
     
-    if (doc["wifi_ssid"].is<String>()) {
-        String wifiSSID = doc["wifi_ssid"].as<String>();
+    if (doc["wifi_ssid"].is<const char*>()) {
+        const char* wifiSSID = doc["wifi_ssid"].as<const char*>();
         setConfigValue("wifi_ssid", wifiSSID);
-        Serial.println("Saved WiFi SSID: " + wifiSSID);
+        Serial.printf("Saved WiFi SSID: %s\n", wifiSSID);
     }
     
-    if (doc["wifi_password"].is<String>()) {
-        String wifiPassword = doc["wifi_password"].as<String>();
-        setConfigValue("wifi_password", wifiPassword);
+    if (doc["wifi_password"].is<const char*>()) {
+        setConfigValue("wifi_password", doc["wifi_password"].as<const char*>());
         Serial.println("Saved WiFi password: [HIDDEN]");
     }
     
+    // An empty field keeps the current secret (it is never sent back to the page)
+    if (doc["ota_secret"].is<const char*>() && strlen(doc["ota_secret"].as<const char*>()) > 0) {
+        setConfigValue("ota_secret", doc["ota_secret"].as<const char*>());
+        Serial.println("Saved OTA secret: [HIDDEN]");
+    }
+    
     Serial.println("Configuration saved successfully");
 }
 
@@ -294,30 +1524,89 @@ String getConfigValue(const String& key, const String& defaultValue) {
     return preferences.getString(key.c_str(), defaultValue);
 }
 
-void setConfigValue(const String& key, const String& value) {
-    preferences.putString(key.c_str(), value);
+void setConfigValue(const char* key, const char* value) {
+    preferences.putString(key, value);
+}
+
+void setConfigValue(const char* key, int value) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", value);
+    preferences.putString(key, buf);
 }
 
 // ===== SENSOR DATA GENERATOR =====
 
 String generateSensorDataJSON() {
-    JsonDocument doc;
+    TelemetryScope scope("status");
+    
+    JsonDocument doc(&requestArena);
     
     doc["timestamp"] = millis();
     doc["status"] = "running";
     
     // AC control data
     doc["ac"]["current_model"] = currentACModel;
-    doc["ac"]["model_name"] = String(AC_MODEL_NAMES[currentACModel]);
+    doc["ac"]["model_name"] = AC_MODEL_NAMES[currentACModel];
+    
+    // Pulse train cache
+    const PulseCache& cache = acController.cache();
+    uint32_t lookups = cache.hits() + cache.misses();
+    doc["ac"]["pulse_cache"]["hits"] = cache.hits();
+    doc["ac"]["pulse_cache"]["misses"] = cache.misses();
+    doc["ac"]["pulse_cache"]["hit_rate"] = lookups > 0 ? (float)cache.hits() / lookups : 0.0f;
+    doc["ac"]["pulse_cache"]["entries"] = cache.entries();
+    doc["ac"]["pulse_cache"]["uncacheable"] = cache.uncacheable();
+    doc["ac"]["pulse_cache"]["unstable"] = cache.unstable();
+    doc["ac"]["pulse_cache"]["pinned"] = cache.pinned();
+    doc["ac"]["pulse_cache"]["bytes_used"] = cache.bytesUsed();
+    doc["ac"]["pulse_cache"]["bytes_budget"] = cache.bytesBudget();
+    
+    // IR receiver (physical remotes)
+    doc["ir_receiver"]["enabled"] = irReceiver.enabled();
+    if (irReceiver.enabled()) {
+        doc["ir_receiver"]["frames"] = irReceiver.frames();
+        doc["ir_receiver"]["decoded"] = irReceiver.decoded();
+        doc["ir_receiver"]["unknown"] = irReceiver.unknown();
+        doc["ir_receiver"]["adopted"] = irReceiver.adopted();
+        doc["ir_receiver"]["ignored"] = irReceiver.ignored();
+        doc["ir_receiver"]["dropped"] = irReceiver.dropped();
+        doc["ir_receiver"]["overflows"] = irReceiver.overflows();
+    }
     
     // System info
+    char ip[16];
+    IPAddress localIP = WiFi.localIP();
+    snprintf(ip, sizeof(ip), "%u.%u.%u.%u", localIP[0], localIP[1], localIP[2], localIP[3]);
+    
+    // Admission control
+    doc["admission"]["depth"] = commandScheduler.depth();
+    doc["admission"]["max_depth"] = commandScheduler.maxDepth();
+    doc["admission"]["admitted"] = commandScheduler.admitted();
+    doc["admission"]["rejected_rate"] = commandScheduler.rejectedRate();
+    doc["admission"]["rejected_full"] = commandScheduler.rejectedFull();
+    doc["admission"]["shed"] = commandScheduler.shed();
+    doc["admission"]["avg_wait_ms"] = commandScheduler.avgWaitMs();
+    doc["admission"]["max_wait_ms"] = commandScheduler.maxWaitMs();
+    doc["admission"]["avg_transmit_ms"] = commandScheduler.avgTransmitMs();
+    
     doc["system"]["uptime"] = millis();
     doc["system"]["free_heap"] = ESP.getFreeHeap();
+    doc["system"]["min_free_heap"] = ESP.getMinFreeHeap();
+    doc["system"]["largest_free_block"] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    doc["system"]["boot_count"] = telemetry.bootCount();
+    doc["system"]["reset_reason"] = Telemetry::resetReasonName(telemetry.current().resetReason);
     doc["system"]["wifi_rssi"] = WiFi.RSSI();
     doc["system"]["wifi_connected"] = WiFi.status() == WL_CONNECTED;
-    doc["system"]["ip_address"] = WiFi.localIP().toString();
+    doc["system"]["ip_address"] = ip;
+    
+    // Request arena usage
+    doc["system"]["arena_high_water"] = requestArena.highWater();
+    doc["system"]["arena_capacity"] = requestArena.capacity();
+    doc["system"]["arena_heap_fallbacks"] = requestArena.heapFallbacks();
     
+    // The callback contract returns a String, so size it once up front
     String jsonString;
+    jsonString.reserve(measureJson(doc) + 1);
     serializeJson(doc, jsonString);
     return jsonString;
 }
@@ -332,6 +1621,8 @@ void setupCustomNavigation() {
 // ===== CUSTOM CONTENT GENERATORS =====
 
 String generateHomeContent() {
+    TelemetryScope scope("home");
+    
     String content = "";
 
     // Create comprehensive AC control form
@@ -378,9 +1669,12 @@ String generateHomeContent() {
     
     // Control Buttons
     formContent += IoTWebUI::getButton("Send Command", "primary", "sendACCommand()");
-    formContent += IoTWebUI::getButton("Quick Off", "secondary", "quickOff()");
-    formContent += IoTWebUI::getButton("Quick Cool 24°", "secondary", "quickCool()");
-    formContent += IoTWebUI::getButton("Quick Heat 22°", "secondary", "quickHeat()");
+    
+    // One button per stored scene (names are restricted to [A-Za-z0-9_-])
+    for (size_t i = 0; i < sceneStore.count(); i++) {
+        String name = sceneStore.at(i).name;
+        formContent += IoTWebUI::getButton("Scene: " + name, "secondary", "runScene(&quot;" + name + "&quot;)");
+    }
     
     formContent += "</form>";
     
@@ -405,27 +1699,10 @@ String generateHomeContent() {
     formContent += "    });";
     formContent += "}";
     formContent += "";
-    formContent += "function quickOff() {";
-    formContent += "  const model = document.getElementById('ac_model').value;";
-    formContent += "  fetch(`/set?model=${model}&mode=0&temp=0`)";
+    formContent += "function runScene(name) {";
+    formContent += "  fetch(`/scene?name=${name}`)";
     formContent += "    .then(response => response.text())";
-    formContent += "    .then(data => alert('AC turned off!'))";
-    formContent += "    .catch(error => alert('Error: ' + error));";
-    formContent += "}";
-    formContent += "";
-    formContent += "function quickCool() {";
-    formContent += "  const model = document.getElementById('ac_model').value;";
-    formContent += "  fetch(`/set?model=${model}&mode=1&temp=24&fan=2&swing=0`)";
-    formContent += "    .then(response => response.text())";
-    formContent += "    .then(data => alert('Cool mode activated!'))";
-    formContent += "    .catch(error => alert('Error: ' + error));";
-    formContent += "}";
-    formContent += "";
-    formContent += "function quickHeat() {";
-    formContent += "  const model = document.getElementById('ac_model').value;";
-    formContent += "  fetch(`/set?model=${model}&mode=2&temp=22&fan=2&swing=0`)";
-    formContent += "    .then(response => response.text())";
-    formContent += "    .then(data => alert('Heat mode activated!'))";
+    formContent += "    .then(data => alert(`Scene ${name}: ${data}`))";
     formContent += "    .catch(error => alert('Error: ' + error));";
     formContent += "}";
     formContent += "</script>";
@@ -446,6 +1723,8 @@ String generateHomeContent() {
 }
 
 String generateConfigContent() {
+    TelemetryScope scope("config");
+    
     String content = "";
 
     // Get current values
@@ -478,6 +1757,10 @@ String generateConfigContent() {
     String deviceSection = IoTWebUI::getFormGroup("Device Hostname", "", "text", currentHostname);
     deviceSection += IoTWebUI::getFormGroup("Access Point SSID", "", "text", currentAPSSID);
     deviceSection += IoTWebUI::getFormGroup("Access Point Password", "", "password", currentAPPassword);
+    String otaInput = "<input type='password' id='ota_secret' name='ota_secret' placeholder='";
+    otaInput += getConfigValue("ota_secret", "").length() > 0 ? "Set - leave empty to keep" : "Not set - updates disabled";
+    otaInput += "'>";
+    deviceSection += IoTWebUI::getFormGroup("OTA Secret", otaInput, "select");
     content += IoTWebUI::getSection("Device Settings", deviceSection);
 
     // Action buttons
@@ -0,0 +1,567 @@
+#include <Arduino.h>
+#include <Update.h>
+#include <esp32/rom/miniz.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ota_updater.h"
+
+#define ESP_IMAGE_MAGIC 0xE9
+
+// gzip member header (RFC 1952) parser states
+enum {
+    GZ_FIXED = 0,       // ID1 ID2 CM FLG MTIME(4) XFL OS
+    GZ_EXTRA_LEN,
+    GZ_EXTRA,
+    GZ_NAME,
+    GZ_COMMENT,
+    GZ_HCRC,
+    GZ_DEFLATE
+};
+
+#define GZ_FLAG_HCRC 0x02
+#define GZ_FLAG_EXTRA 0x04
+#define GZ_FLAG_NAME 0x08
+#define GZ_FLAG_COMMENT 0x10
+
+// heatshrink decoder states
+enum {
+    HS_TAG = 0,         // 1 bit: literal or back-reference
+    HS_LITERAL,         // 8 bits
+    HS_INDEX,           // window bits: distance - 1
+    HS_COUNT            // lookahead bits: length - 1
+};
+
+OtaUpdater otaUpdater;
+
+// Next header field present in a gzip stream with these flags
+static uint8_t nextGzipState(uint8_t flags, uint8_t from) {
+    if (from < GZ_EXTRA_LEN && (flags & GZ_FLAG_EXTRA)) return GZ_EXTRA_LEN;
+    if (from < GZ_NAME && (flags & GZ_FLAG_NAME)) return GZ_NAME;
+    if (from < GZ_COMMENT && (flags & GZ_FLAG_COMMENT)) return GZ_COMMENT;
+    if (from < GZ_HCRC && (flags & GZ_FLAG_HCRC)) return GZ_HCRC;
+    return GZ_DEFLATE;
+}
+
+OtaUpdater::OtaUpdater()
+    : _format(OTA_FORMAT_AUTO), _windowBits(OTA_HEATSHRINK_WINDOW_BITS), _lookaheadBits(OTA_HEATSHRINK_LOOKAHEAD_BITS),
+      _state(OTA_IDLE), _restart(true), _connected(false), _received(0), _total(0), _skip(0), _connectReceived(0),
+      _attempts(0), _resumes(0), _retryAt(0), _lastData(0), _startedAt(0), _finishedAt(0), _page(nullptr),
+      _pageFill(0), _written(0), _flashUs(0), _streamEnd(false), _inflator(nullptr), _dict(nullptr), _dictOfs(0),
+      _gzState(GZ_FIXED), _gzFlags(0), _gzCount(0), _gzSkip(0), _window(nullptr), _windowHead(0), _bits(0),
+      _bitCount(0), _hsState(HS_TAG), _hsIndex(0) {
+    _url[0] = '\0';
+    _error[0] = '\0';
+    memset(_expected, 0, sizeof(_expected));
+}
+
+// ===== CONTROL =====
+
+bool OtaUpdater::start(const char* url, const uint8_t sha256[32], OtaFormat format,
+                       uint8_t windowBits, uint8_t lookaheadBits, bool restart) {
+    bool same = strcmp(url, _url) == 0 && memcmp(sha256, _expected, sizeof(_expected)) == 0;
+
+    if (_state == OTA_DOWNLOADING) {
+        if (same) return true;
+        snprintf(_error, sizeof(_error), "Another update is in progress");
+        return false;
+    }
+    if (_state == OTA_DONE) {
+        snprintf(_error, sizeof(_error), "Update installed, restart pending");
+        return false;
+    }
+    if (_state == OTA_PAUSED) {
+        if (same) {
+            Serial.printf("OTA resuming at %u/%u bytes\n", _received, _total);
+            _state = OTA_DOWNLOADING;
+            _restart = restart;
+            _attempts = 0;
+            _retryAt = millis();
+            _error[0] = '\0';
+            return true;
+        }
+    }
+
+    if (strncmp(url, "http://", 7) != 0 || strlen(url) > OTA_URL_MAX) {
+        snprintf(_error, sizeof(_error), "URL must be http:// and at most %d characters", OTA_URL_MAX);
+        return false;
+    }
+    if (format == OTA_FORMAT_HEATSHRINK &&
+        (windowBits < 4 || windowBits > 15 || lookaheadBits < 3 || lookaheadBits >= windowBits)) {
+        snprintf(_error, sizeof(_error), "Invalid heatshrink window/lookahead");
+        return false;
+    }
+
+    // A different image replaces a paused one
+    if (_state == OTA_PAUSED) fail("Replaced by a new update");
+
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
+        snprintf(_error, sizeof(_error), "%s", Update.errorString());
+        return false;
+    }
+    _page = (uint8_t*)malloc(OTA_WRITE_CHUNK);
+    if (_page == nullptr) {
+        Update.abort();
+        snprintf(_error, sizeof(_error), "Out of memory");
+        return false;
+    }
+
+    strcpy(_url, url);
+    memcpy(_expected, sha256, sizeof(_expected));
+    _format = format;
+    _windowBits = windowBits;
+    _lookaheadBits = lookaheadBits;
+    _restart = restart;
+    _error[0] = '\0';
+
+    _connected = false;
+    _received = 0;
+    _total = 0;
+    _skip = 0;
+    _connectReceived = 0;
+    _attempts = 0;
+    _resumes = 0;
+    _pageFill = 0;
+    _written = 0;
+    _flashUs = 0;
+    _streamEnd = false;
+
+    mbedtls_sha256_init(&_sha);
+    mbedtls_sha256_starts(&_sha, 0);
+
+    _state = OTA_DOWNLOADING;
+    _startedAt = millis();
+    _finishedAt = 0;
+    _retryAt = _startedAt;
+    Serial.printf("OTA update from %s\n", _url);
+    return true;
+}
+
+void OtaUpdater::abort() {
+    if (_state == OTA_DOWNLOADING || _state == OTA_PAUSED) {
+        fail("Aborted");
+    }
+}
+
+bool OtaUpdater::restartDue() const {
+    return _state == OTA_DONE && _restart && millis() - _finishedAt >= OTA_RESTART_DELAY_MS;
+}
+
+uint32_t OtaUpdater::elapsedMs() const {
+    if (_startedAt == 0) return 0;
+    if (_state == OTA_DOWNLOADING || _state == OTA_PAUSED) return millis() - _startedAt;
+    return _finishedAt - _startedAt;
+}
+
+const char* OtaUpdater::stateName(OtaState state) {
+    switch (state) {
+        case OTA_DOWNLOADING: return "downloading";
+        case OTA_PAUSED: return "paused";
+        case OTA_DONE: return "done";
+        case OTA_FAILED: return "failed";
+        default: return "idle";
+    }
+}
+
+const char* OtaUpdater::formatName(OtaFormat format) {
+    switch (format) {
+        case OTA_FORMAT_RAW: return "raw";
+        case OTA_FORMAT_GZIP: return "gzip";
+        case OTA_FORMAT_HEATSHRINK: return "heatshrink";
+        default: return "auto";
+    }
+}
+
+// ===== TRANSFER =====
+
+void OtaUpdater::handle() {
+    if (_state != OTA_DOWNLOADING) return;
+    if (!_connected) {
+        if ((long)(millis() - _retryAt) < 0 || !connect()) return;
+    }
+
+    uint8_t buffer[OTA_READ_CHUNK];
+    unsigned long start = millis();
+    while (millis() - start < OTA_PASS_BUDGET_MS) {
+        int available = _client.available();
+        if (available <= 0) {
+            if (!_client.connected()) {
+                interrupted("Connection closed");
+            } else if (millis() - _lastData >= OTA_STALL_TIMEOUT_MS) {
+                interrupted("Connection stalled");
+            }
+            return;
+        }
+
+        // Never read past this response's body
+        size_t want = _total - _received + _skip;
+        if (want > (size_t)available) want = available;
+        if (want > sizeof(buffer)) want = sizeof(buffer);
+        int n = _client.read(buffer, want);
+        if (n <= 0) return;
+        _lastData = millis();
+
+        size_t offset = 0;
+        if (_skip > 0) {
+            offset = (size_t)n < _skip ? n : _skip;
+            _skip -= offset;
+        }
+        if ((size_t)n > offset && !consume(buffer + offset, n - offset)) return;
+
+        if (_received >= _total) {
+            finish();
+            return;
+        }
+    }
+}
+
+bool OtaUpdater::connect() {
+    _http.end();
+    if (!_http.begin(_client, _url)) {
+        fail("Invalid URL");
+        return false;
+    }
+    // HTTP/1.0 keeps the body unchunked so it can be read straight off the socket
+    _http.useHTTP10(true);
+    _http.setReuse(false);
+    // GET() blocks the loop until the headers arrive; keep that short and
+    // leave slow bodies to the non-blocking stall check in handle()
+    _http.setConnectTimeout(OTA_CONNECT_TIMEOUT_MS);
+    _http.setTimeout(OTA_CONNECT_TIMEOUT_MS);
+    static const char* HEADERS[] = {"Content-Range"};
+    _http.collectHeaders(HEADERS, 1);
+
+    if (_received > 0) {
+        char range[24];
+        snprintf(range, sizeof(range), "bytes=%u-", _received);
+        _http.addHeader("Range", range);
+    }
+
+    int code = _http.GET();
+    if (code == HTTP_CODE_PARTIAL_CONTENT) {
+        // "bytes <first>-<last>/<size>"
+        unsigned first = 0, last = 0, size = 0;
+        if (sscanf(_http.header("Content-Range").c_str(), "bytes %u-%u/%u", &first, &last, &size) != 3 ||
+            first != _received) {
+            interrupted("Unusable Content-Range");
+            return false;
+        }
+        if (_total != 0 && size != _total) {
+            fail("Image changed on the server");
+            return false;
+        }
+        _total = size;
+        _skip = 0;
+    } else if (code == HTTP_CODE_OK) {
+        int size = _http.getSize();
+        if (size <= 0) {
+            fail("Server sent no Content-Length");
+            return false;
+        }
+        if (_total != 0 && (uint32_t)size != _total) {
+            fail("Image changed on the server");
+            return false;
+        }
+        _total = size;
+        // Range ignored: the body starts from zero again
+        _skip = _received;
+    } else if (code >= 400 && code < 500) {
+        char reason[24];
+        snprintf(reason, sizeof(reason), "HTTP %d", code);
+        fail(reason);
+        return false;
+    } else {
+        char reason[40];
+        if (code < 0) {
+            snprintf(reason, sizeof(reason), "%s", HTTPClient::errorToString(code).c_str());
+        } else {
+            snprintf(reason, sizeof(reason), "HTTP %d", code);
+        }
+        interrupted(reason);
+        return false;
+    }
+
+    _connected = true;
+    _connectReceived = _received;
+    _lastData = millis();
+    if (_received > 0) {
+        Serial.printf("OTA reconnected at %u/%u bytes (%s)\n", _received, _total,
+                      code == HTTP_CODE_PARTIAL_CONTENT ? "range" : "skipping");
+    }
+    return true;
+}
+
+// Transient failure: reconnect later, or pause once retries stop making progress
+void OtaUpdater::interrupted(const char* reason) {
+    _http.end();
+    _connected = false;
+    snprintf(_error, sizeof(_error), "%s", reason);
+
+    _attempts = _received > _connectReceived ? 1 : _attempts + 1;
+    _connectReceived = _received;
+    if (_attempts > OTA_MAX_RESUMES) {
+        _state = OTA_PAUSED;
+        Serial.printf("OTA paused at %u/%u bytes: %s\n", _received, _total, reason);
+        return;
+    }
+
+    _resumes++;
+    _retryAt = millis() + OTA_RESUME_DELAY_MS;
+    Serial.printf("OTA interrupted at %u/%u bytes (%s), retrying\n", _received, _total, reason);
+}
+
+void OtaUpdater::fail(const char* reason) {
+    _http.end();
+    _connected = false;
+    if (Update.isRunning()) Update.abort();
+    snprintf(_error, sizeof(_error), "%s", reason);
+    _state = OTA_FAILED;
+    _finishedAt = millis();
+    release();
+    Serial.printf("OTA failed: %s\n", reason);
+}
+
+void OtaUpdater::finish() {
+    _http.end();
+    _connected = false;
+
+    if (_format == OTA_FORMAT_GZIP && !_streamEnd) {
+        fail("Truncated gzip stream");
+        return;
+    }
+    if (!flushPage()) return;
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&_sha, digest);
+    if (memcmp(digest, _expected, sizeof(digest)) != 0) {
+        fail("SHA-256 mismatch");
+        return;
+    }
+    if (!Update.end(true)) {
+        fail(Update.errorString());
+        return;
+    }
+
+    _state = OTA_DONE;
+    _error[0] = '\0';
+    _finishedAt = millis();
+    release();
+    Serial.printf("OTA complete: %u -> %u bytes in %u ms (flash writes %u ms, %u resumes)\n",
+                  _total, _written, elapsedMs(), flashMs(), _resumes);
+}
+
+void OtaUpdater::release() {
+    free(_page);
+    free(_inflator);
+    free(_dict);
+    free(_window);
+    _page = nullptr;
+    _inflator = nullptr;
+    _dict = nullptr;
+    _window = nullptr;
+    mbedtls_sha256_free(&_sha);
+}
+
+// ===== DECODING =====
+
+bool OtaUpdater::prepareDecoder(uint8_t firstByte) {
+    if (_format == OTA_FORMAT_AUTO) {
+        if (firstByte == 0x1f) {
+            _format = OTA_FORMAT_GZIP;
+        } else if (firstByte == ESP_IMAGE_MAGIC) {
+            _format = OTA_FORMAT_RAW;
+        } else {
+            fail("Unrecognised image, set format");
+            return false;
+        }
+    }
+
+    if (_format == OTA_FORMAT_GZIP) {
+        _inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+        _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+        if (_inflator == nullptr || _dict == nullptr) {
+            fail("Out of memory");
+            return false;
+        }
+        tinfl_init(_inflator);
+        _dictOfs = 0;
+        _gzState = GZ_FIXED;
+        _gzFlags = 0;
+        _gzCount = 0;
+        _gzSkip = 0;
+    } else if (_format == OTA_FORMAT_HEATSHRINK) {
+        // Back-references before the start of the stream read zeros
+        _window = (uint8_t*)calloc(1, 1u << _windowBits);
+        if (_window == nullptr) {
+            fail("Out of memory");
+            return false;
+        }
+        _windowHead = 0;
+        _bits = 0;
+        _bitCount = 0;
+        _hsState = HS_TAG;
+    }
+    return true;
+}
+
+bool OtaUpdater::consume(const uint8_t* data, size_t len) {
+    if (_received == 0 && !prepareDecoder(data[0])) return false;
+    _received += len;
+
+    switch (_format) {
+        case OTA_FORMAT_GZIP: return gunzip(data, len);
+        case OTA_FORMAT_HEATSHRINK: return unshrink(data, len);
+        default: return emit(data, len);
+    }
+}
+
+bool OtaUpdater::gunzip(const uint8_t* data, size_t len) {
+    // Header fields can straddle reads, so they are parsed a byte at a time
+    while (len > 0 && _gzState != GZ_DEFLATE) {
+        uint8_t b = *data++;
+        len--;
+        switch (_gzState) {
+            case GZ_FIXED:
+                if ((_gzCount == 0 && b != 0x1f) || (_gzCount == 1 && b != 0x8b) || (_gzCount == 2 && b != 8)) {
+                    fail("Not a gzip (deflate) stream");
+                    return false;
+                }
+                if (_gzCount == 3) _gzFlags = b;
+                if (++_gzCount == 10) {
+                    _gzCount = 0;
+                    _gzState = nextGzipState(_gzFlags, GZ_FIXED);
+                }
+                break;
+            case GZ_EXTRA_LEN:
+                _gzSkip |= b << (8 * _gzCount);
+                if (++_gzCount == 2) {
+                    _gzCount = 0;
+                    _gzState = _gzSkip > 0 ? (uint8_t)GZ_EXTRA : nextGzipState(_gzFlags, GZ_EXTRA);
+                }
+                break;
+            case GZ_EXTRA:
+                if (--_gzSkip == 0) _gzState = nextGzipState(_gzFlags, GZ_EXTRA);
+                break;
+            case GZ_NAME:
+            case GZ_COMMENT:
+                if (b == 0) _gzState = nextGzipState(_gzFlags, _gzState);
+                break;
+            case GZ_HCRC:
+                if (++_gzCount == 2) {
+                    _gzCount = 0;
+                    _gzState = GZ_DEFLATE;
+                }
+                break;
+        }
+    }
+
+    // Whatever follows the deflate stream is the CRC32/ISIZE trailer,
+    // which the SHA-256 check makes redundant
+    if (len == 0 || _streamEnd) return true;
+    return inflate(data, len);
+}
+
+bool OtaUpdater::inflate(const uint8_t* data, size_t len) {
+    for (;;) {
+        size_t inBytes = len;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - _dictOfs;
+        tinfl_status status = tinfl_decompress(_inflator, data, &inBytes, _dict, _dict + _dictOfs, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        len -= inBytes;
+
+        if (outBytes > 0 && !emit(_dict + _dictOfs, outBytes)) return false;
+        _dictOfs = (_dictOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (status == TINFL_STATUS_DONE) {
+            _streamEnd = true;
+            return true;
+        }
+        if (status < 0) {
+            fail("Corrupt deflate data");
+            return false;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return true;
+    }
+}
+
+// heatshrink bit stream, MSB first: a 1 tag bit is followed by a literal
+// byte, a 0 tag bit by a (distance - 1, length - 1) back-reference into
+// the window. Trailing padding bits never complete a token.
+bool OtaUpdater::unshrink(const uint8_t* data, size_t len) {
+    uint16_t mask = (1u << _windowBits) - 1;
+    for (size_t i = 0; i < len; i++) {
+        _bits = (_bits << 8) | data[i];
+        _bitCount += 8;
+
+        for (;;) {
+            uint8_t need = _hsState == HS_TAG ? 1
+                         : _hsState == HS_LITERAL ? 8
+                         : _hsState == HS_INDEX ? _windowBits
+                         : _lookaheadBits;
+            if (_bitCount < need) break;
+            _bitCount -= need;
+            uint16_t value = (_bits >> _bitCount) & ((1u << need) - 1);
+
+            switch (_hsState) {
+                case HS_TAG:
+                    _hsState = value ? HS_LITERAL : HS_INDEX;
+                    break;
+                case HS_LITERAL:
+                    if (!emitShrunk(value)) return false;
+                    _hsState = HS_TAG;
+                    break;
+                case HS_INDEX:
+                    _hsIndex = value + 1;
+                    _hsState = HS_COUNT;
+                    break;
+                case HS_COUNT:
+                    for (uint16_t n = 0; n <= value; n++) {
+                        if (!emitShrunk(_window[(uint16_t)(_windowHead - _hsIndex) & mask])) return false;
+                    }
+                    _hsState = HS_TAG;
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
+bool OtaUpdater::emitShrunk(uint8_t c) {
+    _window[_windowHead++ & ((1u << _windowBits) - 1)] = c;
+    _page[_pageFill++] = c;
+    return _pageFill < OTA_WRITE_CHUNK || flushPage();
+}
+
+// ===== OUTPUT =====
+
+bool OtaUpdater::emit(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t n = OTA_WRITE_CHUNK - _pageFill;
+        if (n > len) n = len;
+        memcpy(_page + _pageFill, data, n);
+        _pageFill += n;
+        data += n;
+        len -= n;
+        if (_pageFill == OTA_WRITE_CHUNK && !flushPage()) return false;
+    }
+    return true;
+}
+
+// Hash and write one page; the hash covers exactly what lands in flash
+bool OtaUpdater::flushPage() {
+    if (_pageFill == 0) return true;
+    mbedtls_sha256_update(&_sha, _page, _pageFill);
+
+    uint32_t start = micros();
+    size_t written = Update.write(_page, _pageFill);
+    _flashUs += micros() - start;
+    if (written != _pageFill) {
+        fail(Update.errorString());
+        return false;
+    }
+
+    _written += _pageFill;
+    _pageFill = 0;
+    return true;
+}
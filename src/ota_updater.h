@@ -0,0 +1,137 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <mbedtls/sha256.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+enum OtaFormat : uint8_t {
+    OTA_FORMAT_AUTO = 0,        // gzip or raw, from the first byte
+    OTA_FORMAT_RAW = 1,
+    OTA_FORMAT_GZIP = 2,
+    OTA_FORMAT_HEATSHRINK = 3   // No header; window/lookahead must match the encoder
+};
+
+enum OtaState : uint8_t {
+    OTA_IDLE = 0,
+    OTA_DOWNLOADING = 1,
+    OTA_PAUSED = 2,             // Gave up reconnecting; the same request resumes it
+    OTA_DONE = 3,               // Verified and set as boot partition, restart pending
+    OTA_FAILED = 4
+};
+
+// Pulls a firmware image over HTTP and streams it into the inactive app
+// partition. The download is advanced a few milliseconds at a time from
+// loop(), so the web server and IR transmitter stay responsive. Only
+// (re)connecting blocks: DNS, then up to OTA_CONNECT_TIMEOUT_MS each for the
+// TCP connect and the response headers. Compressed
+// images are decoded on the fly into a one-sector page buffer; nothing
+// close to the image size is ever held in RAM.
+//
+// A dropped connection is resumed with a Range request from the last byte
+// consumed - the decoder state lives in RAM, so the stream simply carries
+// on. Servers that ignore Range are handled by discarding the bytes already
+// seen. The SHA-256 of the decompressed image must match before the new
+// partition is marked bootable.
+class OtaUpdater {
+public:
+    OtaUpdater();
+
+    // Start an update, or resume a paused one with the same URL and hash.
+    // Returns false (see error()) if the request is invalid or another
+    // update is downloading.
+    bool start(const char* url, const uint8_t sha256[32], OtaFormat format,
+               uint8_t windowBits, uint8_t lookaheadBits, bool restart);
+    void abort();
+    void handle();
+
+    // Reboot into the new image once clients had a chance to see the result
+    bool restartDue() const;
+
+    OtaState state() const { return _state; }
+    const char* error() const { return _error; }
+    const char* url() const { return _url; }
+    OtaFormat format() const { return _format; }
+    static const char* stateName(OtaState state);
+    static const char* formatName(OtaFormat format);
+
+    // Progress and throughput
+    uint32_t received() const { return _received; }   // Compressed bytes consumed
+    uint32_t total() const { return _total; }         // Compressed image size
+    uint32_t written() const { return _written; }     // Decompressed bytes written to flash
+    uint32_t resumes() const { return _resumes; }
+    uint32_t elapsedMs() const;
+    uint32_t flashMs() const { return _flashUs / 1000; }
+
+private:
+    char _url[OTA_URL_MAX + 1];
+    uint8_t _expected[32];
+    OtaFormat _format;
+    uint8_t _windowBits;
+    uint8_t _lookaheadBits;
+    OtaState _state;
+    bool _restart;              // Reboot into the new image when done
+    char _error[48];
+
+    // Transfer
+    HTTPClient _http;
+    WiFiClient _client;
+    bool _connected;
+    uint32_t _received;
+    uint32_t _total;
+    uint32_t _skip;             // Bytes to discard after a server ignored our Range
+    uint32_t _connectReceived;  // _received when the current connection opened
+    uint8_t _attempts;          // Reconnects without progress
+    uint32_t _resumes;
+    unsigned long _retryAt;
+    unsigned long _lastData;
+    unsigned long _startedAt;
+    unsigned long _finishedAt;
+
+    // Output
+    mbedtls_sha256_context _sha;
+    uint8_t* _page;
+    uint16_t _pageFill;
+    uint32_t _written;
+    uint32_t _flashUs;
+    bool _streamEnd;            // The decoder saw the end of the compressed stream
+
+    // gzip: header parser, then ROM tinfl with a 32 KB wrapping dictionary
+    struct tinfl_decompressor_tag* _inflator;
+    uint8_t* _dict;
+    size_t _dictOfs;
+    uint8_t _gzState;
+    uint8_t _gzFlags;
+    uint16_t _gzCount;
+    uint16_t _gzSkip;
+
+    // heatshrink: bit reader and 2^window sliding window
+    uint8_t* _window;
+    uint16_t _windowHead;
+    uint32_t _bits;
+    uint8_t _bitCount;
+    uint8_t _hsState;
+    uint16_t _hsIndex;
+
+    bool connect();
+    void interrupted(const char* reason);
+    void fail(const char* reason);
+    void finish();
+    void release();
+
+    bool prepareDecoder(uint8_t firstByte);
+    bool consume(const uint8_t* data, size_t len);
+    bool gunzip(const uint8_t* data, size_t len);
+    bool inflate(const uint8_t* data, size_t len);
+    bool unshrink(const uint8_t* data, size_t len);
+    bool emit(const uint8_t* data, size_t len);
+    bool emitShrunk(uint8_t c);
+    bool flushPage();
+};
+
+extern OtaUpdater otaUpdater;
+
+#endif // OTA_UPDATER_H
@@ -0,0 +1,327 @@
+#include <Arduino.h>
+#include <string.h>
+#include "pulse_cache.h"
+
+// A gap longer than this between carrier pulses ends a mark
+#define PULSE_GAP_US 100
+
+// Durations within 1/8 of an existing dictionary entry reuse it
+#define PULSE_TOLERANCE_SHIFT 3
+
+static PulseCache* activeCapture = nullptr;
+static volatile bool edgeProbeArmed = false;
+static volatile bool edgeProbeHit = false;
+static volatile uint32_t edgeProbeTime = 0;
+
+// arduino-esp32 defines digitalWrite() as a weak alias of __digitalWrite(),
+// which is what IRsend::ledOn()/ledOff() end up calling. Overriding it lets
+// us observe the exact pulse train IRac produces for the IR pin.
+extern "C" void __digitalWrite(uint8_t pin, uint8_t val);
+
+extern "C" void digitalWrite(uint8_t pin, uint8_t val) {
+    if (edgeProbeArmed && pin == IR_LED_PIN && val != LOW) {
+        edgeProbeTime = micros();
+        edgeProbeHit = true;
+        edgeProbeArmed = false;
+    }
+    
+    PulseCache* capture = activeCapture;
+    if (capture != nullptr && pin == IR_LED_PIN) {
+        capture->recordEdge(val != LOW, micros());
+        if (capture->silent()) return;
+    }
+    __digitalWrite(pin, val);
+}
+
+PulseCache::PulseCache()
+    : _tick(0), _hits(0), _misses(0), _uncacheable(0), _unstable(0), _dirty(false),
+      _capturing(false), _silent(false), _overflow(false), _started(false),
+      _captured(0), _markStart(0), _lastOn(0), _lastOff(0), _carrierSum(0), _carrierCount(0) {
+    memset(_slots, 0, sizeof(_slots));
+    memset(_pending, 0, sizeof(_pending));
+}
+
+uint32_t PulseCache::makeKey(int model, int mode, int temp, int fan, bool swing) {
+    return ((uint32_t)(model & 0xff) << 24) | ((uint32_t)(mode & 0xff) << 16) |
+           ((uint32_t)(temp & 0xff) << 8) | ((uint32_t)(fan & 0x7f) << 1) | (swing ? 1 : 0);
+}
+
+void PulseCache::splitKey(uint32_t key, int& model, int& mode, int& temp, int& fan, bool& swing) {
+    model = (key >> 24) & 0xff;
+    mode = (key >> 16) & 0xff;
+    temp = (key >> 8) & 0xff;
+    fan = (key >> 1) & 0x7f;
+    swing = key & 1;
+}
+
+void PulseCache::armEdgeProbe() {
+    edgeProbeHit = false;
+    edgeProbeArmed = true;
+}
+
+bool PulseCache::takeFirstEdge(uint32_t& micros) {
+    edgeProbeArmed = false;
+    micros = edgeProbeTime;
+    return edgeProbeHit;
+}
+
+// ===== LOOKUP =====
+
+PulseCache::Slot* PulseCache::find(uint32_t key) {
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (_slots[i].valid && _slots[i].key == key) return &_slots[i];
+    }
+    return nullptr;
+}
+
+const PulseCache::Slot* PulseCache::find(uint32_t key) const {
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (_slots[i].valid && _slots[i].key == key) return &_slots[i];
+    }
+    return nullptr;
+}
+
+bool PulseCache::contains(uint32_t key) const {
+    return find(key) != nullptr;
+}
+
+// The pin limit guarantees at least one unpinned slot
+PulseCache::Slot* PulseCache::victim() {
+    Slot* oldest = nullptr;
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (!_slots[i].valid) return &_slots[i];
+        if (_slots[i].pinned) continue;
+        if (oldest == nullptr || _slots[i].lastUsed < oldest->lastUsed) oldest = &_slots[i];
+    }
+    return oldest;
+}
+
+bool PulseCache::pin(uint32_t key) {
+    Slot* slot = find(key);
+    if (slot == nullptr) return false;
+    if (slot->pinned) return true;
+    if (pinned() >= PULSE_CACHE_MAX_PINNED) return false;
+    slot->pinned = true;
+    return true;
+}
+
+void PulseCache::unpinAll() {
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        _slots[i].pinned = false;
+    }
+}
+
+size_t PulseCache::pinned() const {
+    size_t count = 0;
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (_slots[i].valid && _slots[i].pinned) count++;
+    }
+    return count;
+}
+
+bool PulseCache::replay(uint32_t key, IRsend* irsend) {
+    Slot* slot = find(key);
+    if (slot == nullptr) {
+        _misses++;
+        return false;
+    }
+
+    for (uint16_t i = 0; i < slot->count; i++) {
+        uint8_t nibble = (slot->packed[i / 2] >> ((i & 1) * 4)) & 0xf;
+        _raw[i] = slot->symbols[nibble];
+    }
+
+    _hits++;
+    slot->hitCount++;
+    slot->lastUsed = ++_tick;
+    irsend->sendRaw(_raw, slot->count, slot->frequency);
+    return true;
+}
+
+// ===== CAPTURE =====
+
+void PulseCache::beginCapture(bool silent) {
+    _silent = silent;
+    _overflow = false;
+    _started = false;
+    _captured = 0;
+    _carrierSum = 0;
+    _carrierCount = 0;
+    _capturing = true;
+    activeCapture = this;
+}
+
+void PulseCache::push(uint32_t duration) {
+    if (_captured >= PULSE_CACHE_MAX_PULSES || duration > 0xffff) {
+        _overflow = true;
+        return;
+    }
+    _raw[_captured++] = duration;
+}
+
+void PulseCache::recordEdge(bool on, uint32_t now) {
+    if (on) {
+        if (!_started) {
+            _started = true;
+            _markStart = now;
+        } else if (now - _lastOff > PULSE_GAP_US) {
+            // Previous mark ended at the last falling edge
+            push(_lastOff - _markStart);
+            push(now - _lastOff);
+            _markStart = now;
+        } else {
+            _carrierSum += now - _lastOn;
+            _carrierCount++;
+        }
+        _lastOn = now;
+    } else if (_started) {
+        _lastOff = now;
+    }
+}
+
+// First dictionary entry within tolerance of `duration`, or `count` if none
+static uint8_t symbolIndex(const uint16_t* symbols, uint8_t count, uint16_t duration) {
+    uint8_t index = 0;
+    while (index < count) {
+        uint16_t symbol = symbols[index];
+        uint16_t delta = duration > symbol ? duration - symbol : symbol - duration;
+        if (delta <= (symbol >> PULSE_TOLERANCE_SHIFT)) break;
+        index++;
+    }
+    return index;
+}
+
+// Encode the current capture into `slot`; false if it has too many
+// distinct timings for the 4-bit indices
+bool PulseCache::encode(Slot& slot, uint32_t key) const {
+    uint8_t symbolCount = 0;
+    for (uint16_t i = 0; i < _captured; i++) {
+        if (symbolIndex(slot.symbols, symbolCount, _raw[i]) < symbolCount) continue;
+        if (symbolCount == 16) return false;
+        slot.symbols[symbolCount++] = _raw[i];
+    }
+
+    slot.symbolCount = symbolCount;
+    memset(slot.packed, 0, sizeof(slot.packed));
+    // Matching is first-fit in table order, so every duration gets the
+    // same index it was assigned above
+    for (uint16_t i = 0; i < _captured; i++) {
+        slot.packed[i / 2] |= symbolIndex(slot.symbols, symbolCount, _raw[i]) << ((i & 1) * 4);
+    }
+
+    uint32_t frequency = 38;
+    if (_carrierCount > 0) {
+        uint32_t period = _carrierSum / _carrierCount;
+        if (period > 0) frequency = (1000 + period / 2) / period;
+    }
+
+    slot.key = key;
+    slot.count = _captured;
+    slot.frequency = frequency;
+    slot.hitCount = 0;
+    slot.valid = true;
+    slot.pinned = false;
+    return true;
+}
+
+// Whether the current capture has the same pulses as `slot`, within tolerance
+bool PulseCache::matches(const Slot& slot) const {
+    if (slot.count != _captured) return false;
+    for (uint16_t i = 0; i < _captured; i++) {
+        uint8_t nibble = (slot.packed[i / 2] >> ((i & 1) * 4)) & 0xf;
+        if (symbolIndex(&slot.symbols[nibble], 1, _raw[i]) != 0) return false;
+    }
+    return true;
+}
+
+void PulseCache::endCapture(uint32_t key) {
+    activeCapture = nullptr;
+    _capturing = false;
+    if (_started) {
+        push(_lastOff - _markStart);
+    }
+
+    if (!_started || _overflow) {
+        _uncacheable++;
+        return;
+    }
+
+    // A mark split by a late interrupt or a WiFi burst looks like any other
+    // capture, so the first render of a state is only a candidate. It is
+    // stored once the next render of the same state agrees with it.
+    Slot* candidate = nullptr;
+    for (int i = 0; i < PULSE_CACHE_PENDING; i++) {
+        if (_pending[i].valid && _pending[i].key == key) candidate = &_pending[i];
+    }
+    if (candidate == nullptr || !matches(*candidate)) {
+        if (candidate != nullptr) {
+            _unstable++;
+        } else {
+            // Replace the oldest candidate
+            candidate = &_pending[0];
+            for (int i = 0; i < PULSE_CACHE_PENDING; i++) {
+                if (!_pending[i].valid) {
+                    candidate = &_pending[i];
+                    break;
+                }
+                if (_pending[i].lastUsed < candidate->lastUsed) candidate = &_pending[i];
+            }
+        }
+        candidate->valid = false;
+        if (!encode(*candidate, key)) {
+            _uncacheable++;
+            return;
+        }
+        candidate->lastUsed = ++_tick;
+        return;
+    }
+
+    // The victim is chosen only now, so a rejected capture leaves the cache untouched
+    Slot* slot = victim();
+    *slot = *candidate;
+    slot->lastUsed = ++_tick;
+    candidate->valid = false;
+    _dirty = true;
+}
+
+// ===== STATISTICS =====
+
+size_t PulseCache::hotKeys(uint32_t* out, size_t maxKeys) const {
+    size_t count = 0;
+    bool taken[PULSE_CACHE_SLOTS] = {false};
+    while (count < maxKeys) {
+        int best = -1;
+        for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+            if (!_slots[i].valid || taken[i]) continue;
+            if (best < 0 || _slots[i].hitCount > _slots[best].hitCount) best = i;
+        }
+        if (best < 0) break;
+        taken[best] = true;
+        out[count++] = _slots[best].key;
+    }
+    return count;
+}
+
+bool PulseCache::takeDirty() {
+    bool dirty = _dirty;
+    _dirty = false;
+    return dirty;
+}
+
+size_t PulseCache::entries() const {
+    size_t count = 0;
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (_slots[i].valid) count++;
+    }
+    return count;
+}
+
+size_t PulseCache::bytesUsed() const {
+    size_t bytes = 0;
+    for (int i = 0; i < PULSE_CACHE_SLOTS; i++) {
+        if (_slots[i].valid) {
+            bytes += _slots[i].symbolCount * sizeof(uint16_t) + (_slots[i].count + 1) / 2;
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,106 @@
+#ifndef PULSE_CACHE_H
+#define PULSE_CACHE_H
+
+#include <IRsend.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// LRU cache of rendered IRac pulse trains.
+// IRremoteESP8266 offers no hook between encoding and transmission, so the
+// first send of a state is captured at the GPIO level (see digitalWrite()
+// in pulse_cache.cpp) and reduced to its mark/space envelope. Entries are
+// stored as a small duration dictionary plus 4-bit indices and replayed
+// with sendRaw(), skipping protocol encoding entirely. A capture is only
+// stored once two consecutive renders of the same state agree, so a
+// transmit disturbed by an interrupt or WiFi is never replayed.
+class PulseCache {
+public:
+    PulseCache();
+
+    static uint32_t makeKey(int model, int mode, int temp, int fan, bool swing);
+    static void splitKey(uint32_t key, int& model, int& mode, int& temp, int& fan, bool& swing);
+
+    // Send a cached pulse train; returns false on a miss
+    bool replay(uint32_t key, IRsend* irsend);
+
+    // Capture everything written to the IR pin between these two calls.
+    // A silent capture records without driving the LED (used for warm-up).
+    void beginCapture(bool silent);
+    void endCapture(uint32_t key);
+
+    // Most-hit keys, for persisting the warm-up list
+    size_t hotKeys(uint32_t* out, size_t maxKeys) const;
+    bool contains(uint32_t key) const;
+    bool takeDirty();
+
+    // Pinned entries are never evicted (scene steps); at most
+    // PULSE_CACHE_MAX_PINNED slots may be pinned at once
+    bool pin(uint32_t key);
+    void unpinAll();
+    size_t pinned() const;
+
+    // Statistics
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t uncacheable() const { return _uncacheable; }
+    uint32_t unstable() const { return _unstable; }
+    size_t entries() const;
+    size_t bytesUsed() const;
+    size_t bytesBudget() const { return sizeof(_slots); }
+
+    // One-shot probe for the first edge on the IR pin, used to split
+    // encode time from transmit time
+    static void armEdgeProbe();
+    static bool takeFirstEdge(uint32_t& micros);
+
+    // Called from the digitalWrite() override
+    void recordEdge(bool on, uint32_t now);
+    bool capturing() const { return _capturing; }
+    bool silent() const { return _silent; }
+
+private:
+    struct Slot {
+        uint32_t key;
+        uint32_t lastUsed;
+        uint32_t hitCount;
+        uint16_t count;          // Number of mark/space durations
+        uint8_t frequency;       // Carrier in kHz
+        uint8_t symbolCount;
+        bool valid;
+        bool pinned;
+        uint16_t symbols[16];
+        uint8_t packed[PULSE_CACHE_MAX_PULSES / 2];
+    };
+
+    Slot _slots[PULSE_CACHE_SLOTS];
+    Slot _pending[PULSE_CACHE_PENDING];   // First renders, waiting for a second that agrees
+    uint16_t _raw[PULSE_CACHE_MAX_PULSES];
+    uint32_t _tick;
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _uncacheable;
+    uint32_t _unstable;
+    bool _dirty;
+
+    // Capture state
+    volatile bool _capturing;
+    bool _silent;
+    bool _overflow;
+    bool _started;
+    uint16_t _captured;
+    uint32_t _markStart;
+    uint32_t _lastOn;
+    uint32_t _lastOff;
+    uint32_t _carrierSum;
+    uint32_t _carrierCount;
+
+    void push(uint32_t duration);
+    bool encode(Slot& slot, uint32_t key) const;
+    bool matches(const Slot& slot) const;
+    Slot* find(uint32_t key);
+    const Slot* find(uint32_t key) const;
+    Slot* victim();
+};
+
+#endif // PULSE_CACHE_H
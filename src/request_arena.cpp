@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include <string.h>
+#include "request_arena.h"
+
+// Each block is preceded by an 8-byte header holding its size so that
+// reallocate() knows how much to copy and can grow the last block in place.
+#define ARENA_ALIGN 8
+#define ARENA_HEADER 8
+#define ARENA_NO_BLOCK ((size_t)-1)
+
+static inline size_t alignUp(size_t n) {
+    return (n + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+RequestArena requestArena;
+
+RequestArena::RequestArena() : _used(0), _last(ARENA_NO_BLOCK), _highWater(0), _heapFallbacks(0) {
+}
+
+bool RequestArena::owns(const void* ptr) const {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    return p >= _buffer && p < _buffer + REQUEST_ARENA_SIZE;
+}
+
+size_t RequestArena::blockSize(const void* ptr) const {
+    uint32_t size;
+    memcpy(&size, static_cast<const uint8_t*>(ptr) - ARENA_HEADER, sizeof(size));
+    return size;
+}
+
+void* RequestArena::allocate(size_t size) {
+    size_t needed = ARENA_HEADER + alignUp(size);
+    if (_used + needed > REQUEST_ARENA_SIZE) {
+        _heapFallbacks++;
+        return malloc(size);
+    }
+
+    uint8_t* header = _buffer + _used;
+    uint32_t stored = size;
+    memcpy(header, &stored, sizeof(stored));
+    _last = _used;
+    _used += needed;
+    if (_used > _highWater) _highWater = _used;
+    return header + ARENA_HEADER;
+}
+
+void RequestArena::deallocate(void* ptr) {
+    if (ptr == nullptr) return;
+    if (!owns(ptr)) {
+        free(ptr);
+        return;
+    }
+    // Only the most recent block can be given back before reset()
+    if (_last != ARENA_NO_BLOCK && ptr == _buffer + _last + ARENA_HEADER) {
+        _used = _last;
+        _last = ARENA_NO_BLOCK;
+    }
+}
+
+void* RequestArena::reallocate(void* ptr, size_t newSize) {
+    if (ptr == nullptr) return allocate(newSize);
+    if (!owns(ptr)) return realloc(ptr, newSize);
+
+    // Grow or shrink the last block in place (ArduinoJson's pool growth
+    // and shrinkToFit() both hit this path)
+    if (_last != ARENA_NO_BLOCK && ptr == _buffer + _last + ARENA_HEADER) {
+        size_t end = _last + ARENA_HEADER + alignUp(newSize);
+        if (end <= REQUEST_ARENA_SIZE) {
+            uint32_t stored = newSize;
+            memcpy(_buffer + _last, &stored, sizeof(stored));
+            _used = end;
+            if (_used > _highWater) _highWater = _used;
+            return ptr;
+        }
+    }
+
+    size_t oldSize = blockSize(ptr);
+    void* moved = allocate(newSize);
+    if (moved != nullptr) {
+        memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+    }
+    return moved;
+}
+
+void RequestArena::reset() {
+    _used = 0;
+    _last = ARENA_NO_BLOCK;
+}
@@ -0,0 +1,45 @@
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Per-request bump allocator.
+// Everything a handler needs while building or parsing JSON is carved out of
+// one static buffer and released in one go by reset() once the request has
+// been answered, so steady-state request handling never touches the general
+// heap. Allocations that do not fit fall back to malloc() and are counted.
+class RequestArena : public ArduinoJson::Allocator {
+public:
+    RequestArena();
+
+    // ArduinoJson allocator interface
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    // Release everything allocated since the last reset
+    void reset();
+
+    // Statistics
+    size_t used() const { return _used; }
+    size_t highWater() const { return _highWater; }
+    size_t capacity() const { return REQUEST_ARENA_SIZE; }
+    uint32_t heapFallbacks() const { return _heapFallbacks; }
+
+private:
+    alignas(8) uint8_t _buffer[REQUEST_ARENA_SIZE];
+    size_t _used;
+    size_t _last;        // Offset of the most recent block header
+    size_t _highWater;
+    uint32_t _heapFallbacks;
+
+    bool owns(const void* ptr) const;
+    size_t blockSize(const void* ptr) const;
+};
+
+extern RequestArena requestArena;
+
+#endif // REQUEST_ARENA_H
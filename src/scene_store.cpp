@@ -0,0 +1,238 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <string.h>
+#include "scene_store.h"
+
+#define SCENE_FILE "/scenes.bin"
+#define SCENE_MAGIC 0x5343454e  // "SCEN"
+
+struct SceneFileHeader {
+    uint32_t magic;
+    uint16_t stepSize;
+    uint8_t maxSteps;
+    uint8_t count;
+};
+
+SceneStore sceneStore;
+
+SceneStore::SceneStore()
+    : _count(0), _callback(nullptr), _storageReady(false), _listening(false),
+      _active(-1), _step(0), _stepStart(0), _triggers(0) {
+    memset(_scenes, 0, sizeof(_scenes));
+}
+
+void SceneStore::begin(SceneStepCallback callback) {
+    _callback = callback;
+    _storageReady = LittleFS.begin(true);
+    if (_storageReady && LittleFS.exists(SCENE_FILE)) {
+        restore();
+    } else {
+        seedDefaults();
+    }
+    Serial.printf("Loaded %u scene(s)\n", _count);
+}
+
+void SceneStore::listen() {
+    if (_listening) _udp.stop();
+    _listening = _udp.begin(SCENE_UDP_PORT);
+    if (!_listening) {
+        Serial.println("Failed to open scene trigger port");
+    }
+}
+
+void SceneStore::handle() {
+    if (_listening) {
+        while (_udp.parsePacket() > 0) {
+            processPacket();
+        }
+    }
+    advance();
+}
+
+// ===== STORAGE =====
+
+bool SceneStore::validName(const char* name) {
+    size_t len = strlen(name);
+    if (len == 0 || len > SCENE_NAME_MAX) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-') return false;
+    }
+    return true;
+}
+
+const Scene* SceneStore::find(const char* name) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (strcmp(_scenes[i].name, name) == 0) return &_scenes[i];
+    }
+    return nullptr;
+}
+
+bool SceneStore::save(const Scene& scene) {
+    if (!validName(scene.name) || scene.stepCount == 0 || scene.stepCount > SCENE_MAX_STEPS) {
+        return false;
+    }
+
+    const Scene* existing = find(scene.name);
+    int index = existing != nullptr ? existing - _scenes : _count;
+    if (index >= SCENE_MAX_SCENES) return false;
+
+    // Never keep running steps that were just replaced
+    if (index == _active) stop();
+
+    _scenes[index] = scene;
+    if (index == _count) _count++;
+    return persist();
+}
+
+bool SceneStore::remove(const char* name) {
+    const Scene* existing = find(name);
+    if (existing == nullptr) return false;
+
+    int index = existing - _scenes;
+    if (index == _active) {
+        stop();
+    } else if (_active > index) {
+        _active--;
+    }
+
+    memmove(&_scenes[index], &_scenes[index + 1], (_count - index - 1) * sizeof(Scene));
+    _count--;
+    memset(&_scenes[_count], 0, sizeof(Scene));
+    return persist();
+}
+
+// Equivalents of the old home page buttons and Home Assistant scripts
+void SceneStore::seedDefaults() {
+    static const struct {
+        const char* name;
+        uint8_t mode, temp, fan, swing;
+        uint32_t delayMs;
+    } DEFAULTS[] = {
+        {"off", AC_MODE_OFF, 24, AC_FAN_MIN, 0, 0},
+        {"cool", AC_MODE_COOL, 24, 2, 0, 0},
+        {"heat", AC_MODE_HEAT, 22, 2, 0, 0},
+        {"sleep", AC_MODE_COOL, 23, 1, 1, 0},
+        {"sleep", AC_MODE_COOL, 25, 1, 1, 2UL * 60 * 60 * 1000},  // Ease off after two hours
+    };
+
+    _count = 0;
+    memset(_scenes, 0, sizeof(_scenes));
+    for (const auto& d : DEFAULTS) {
+        Scene* scene = const_cast<Scene*>(find(d.name));
+        if (scene == nullptr) {
+            scene = &_scenes[_count++];
+            strcpy(scene->name, d.name);
+        }
+        SceneStep& step = scene->steps[scene->stepCount++];
+        step.model = -1;
+        step.mode = d.mode;
+        step.temp = d.temp;
+        step.fan = d.fan;
+        step.swing = d.swing;
+        step.delayMs = d.delayMs;
+    }
+    persist();
+}
+
+bool SceneStore::persist() {
+    if (!_storageReady) return false;
+
+    File file = LittleFS.open(SCENE_FILE, "w");
+    if (!file) {
+        Serial.println("Failed to save scenes");
+        return false;
+    }
+
+    SceneFileHeader header = {SCENE_MAGIC, sizeof(SceneStep), SCENE_MAX_STEPS, _count};
+    file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const uint8_t*>(_scenes), _count * sizeof(Scene));
+    file.close();
+    return true;
+}
+
+void SceneStore::restore() {
+    File file = LittleFS.open(SCENE_FILE, "r");
+    if (!file) return;
+
+    SceneFileHeader header;
+    bool valid = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 header.magic == SCENE_MAGIC && header.stepSize == sizeof(SceneStep) &&
+                 header.maxSteps == SCENE_MAX_STEPS && header.count <= SCENE_MAX_SCENES &&
+                 file.read(reinterpret_cast<uint8_t*>(_scenes), header.count * sizeof(Scene)) ==
+                     header.count * sizeof(Scene);
+    file.close();
+
+    if (!valid) {
+        Serial.println("Ignoring incompatible scene file");
+        seedDefaults();
+        return;
+    }
+    _count = header.count;
+}
+
+// ===== EXECUTION =====
+
+bool SceneStore::trigger(const char* name) {
+    const Scene* scene = find(name);
+    if (scene == nullptr) return false;
+
+    if (_active >= 0) {
+        Serial.printf("Scene '%s' replaced by '%s'\n", _scenes[_active].name, name);
+    }
+    _active = scene - _scenes;
+    _step = 0;
+    _stepStart = millis();
+    _triggers++;
+    Serial.printf("Scene '%s' started (%u steps)\n", name, scene->stepCount);
+
+    advance();
+    return true;
+}
+
+void SceneStore::stop() {
+    _active = -1;
+    _step = 0;
+}
+
+const char* SceneStore::running() const {
+    return _active >= 0 ? _scenes[_active].name : nullptr;
+}
+
+void SceneStore::advance() {
+    while (_active >= 0) {
+        const Scene& scene = _scenes[_active];
+        if (_step >= scene.stepCount) {
+            Serial.printf("Scene '%s' finished\n", scene.name);
+            stop();
+            return;
+        }
+
+        const SceneStep& step = scene.steps[_step];
+        if (millis() - _stepStart < step.delayMs) return;
+
+        _step++;
+        _stepStart = millis();
+        if (_callback && !_callback(step)) {
+            Serial.printf("Scene '%s' step %u was not accepted\n", scene.name, _step);
+        }
+    }
+}
+
+// A datagram is just the scene name (a trailing newline is ignored);
+// the sender gets a one-line reply
+void SceneStore::processPacket() {
+    char name[SCENE_NAME_MAX + 2];
+    int len = _udp.read(reinterpret_cast<uint8_t*>(name), sizeof(name) - 1);
+    if (len <= 0) return;
+    while (len > 0 && (name[len - 1] == '\n' || name[len - 1] == '\r' || name[len - 1] == ' ')) len--;
+    name[len] = '\0';
+
+    bool ok = validName(name) && trigger(name);
+
+    char reply[SCENE_NAME_MAX + 24];
+    int replyLen = snprintf(reply, sizeof(reply), ok ? "OK %s\n" : "ERR unknown scene %s\n", name);
+    _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+    _udp.write(reinterpret_cast<const uint8_t*>(reply), replyLen);
+    _udp.endPacket();
+}
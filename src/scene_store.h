@@ -0,0 +1,80 @@
+#ifndef SCENE_STORE_H
+#define SCENE_STORE_H
+
+#include <WiFiUdp.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// One command of a scene
+struct SceneStep {
+    int8_t model;                   // -1 = saved model
+    uint8_t mode;
+    uint8_t temp;
+    uint8_t fan;
+    uint8_t swing;
+    uint32_t delayMs;               // Wait after the previous step
+    char zone[GROUP_NAME_MAX + 1];  // Group to fan out to; empty = this device
+};
+
+struct Scene {
+    char name[SCENE_NAME_MAX + 1];
+    uint8_t stepCount;
+    SceneStep steps[SCENE_MAX_STEPS];
+};
+
+typedef bool (*SceneStepCallback)(const SceneStep& step);
+
+// Named command sequences kept in flash and run on the device.
+// A trigger (HTTP or a UDP datagram holding the name) runs the first step
+// straight away; later steps are released from handle() once their delay
+// has passed. Only one scene runs at a time - a new trigger replaces it.
+class SceneStore {
+public:
+    SceneStore();
+
+    // Load scenes (seeding the defaults on first boot)
+    void begin(SceneStepCallback callback);
+    // (Re)open the UDP trigger port; call after WiFi connects
+    void listen();
+    void handle();
+
+    // Storage
+    bool save(const Scene& scene);
+    bool remove(const char* name);
+    const Scene* find(const char* name) const;
+    size_t count() const { return _count; }
+    const Scene& at(size_t index) const { return _scenes[index]; }
+    static bool validName(const char* name);
+
+    // Execution
+    bool trigger(const char* name);
+    void stop();
+    const char* running() const;
+    uint8_t runningStep() const { return _step; }
+    uint32_t triggers() const { return _triggers; }
+
+private:
+    Scene _scenes[SCENE_MAX_SCENES];
+    uint8_t _count;
+    SceneStepCallback _callback;
+    bool _storageReady;
+
+    WiFiUDP _udp;
+    bool _listening;
+
+    int _active;                // Index of the running scene, -1 if idle
+    uint8_t _step;              // Next step to run
+    unsigned long _stepStart;   // When the previous step ran
+    uint32_t _triggers;
+
+    void advance();
+    void processPacket();
+    void seedDefaults();
+    bool persist();
+    void restore();
+};
+
+extern SceneStore sceneStore;
+
+#endif // SCENE_STORE_H
@@ -0,0 +1,163 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <time.h>
+#include <string.h>
+#include "state_history.h"
+
+#define HISTORY_FILE "/history.bin"
+#define HISTORY_MAGIC 0x48495354  // "HIST"
+
+struct HistoryFileHeader {
+    uint32_t magic;
+    uint32_t capacity;
+    uint32_t head;
+};
+
+StateHistory stateHistory;
+
+StateHistory::StateHistory() : _head(0), _checkpointHead(0), _storageReady(false) {
+    memset(_records, 0, sizeof(_records));
+}
+
+void StateHistory::begin() {
+    _storageReady = LittleFS.begin(true);
+    if (!_storageReady) {
+        Serial.println("History storage unavailable - history will not survive reboots");
+        return;
+    }
+    restore();
+}
+
+uint32_t StateHistory::now() {
+    return (uint32_t)time(nullptr);
+}
+
+void StateHistory::append(HistorySource source, int model, int mode, int temp, int fan, bool swing, bool sent) {
+    HistoryRecord record;
+    record.time = now();
+    record.model = model;
+    record.temp = temp;
+    record.flags = (mode & 0x07) | ((fan & 0x07) << 3) | (swing ? 0x40 : 0) | (sent ? 0x80 : 0);
+    record.source = source;
+
+    uint32_t index = _head.fetch_add(1, std::memory_order_relaxed);
+    _records[index % HISTORY_CAPACITY] = record;
+}
+
+size_t StateHistory::size() const {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    return head < HISTORY_CAPACITY ? head : HISTORY_CAPACITY;
+}
+
+// ===== AGGREGATION =====
+
+// Spread [start, end) in `mode` at `temp` over the overlapping buckets
+static void addInterval(uint32_t start, uint32_t end, uint8_t mode, uint8_t temp,
+                        uint32_t from, uint32_t to, uint32_t bucket, HistoryBucket* out) {
+    if (start < from) start = from;
+    if (end > to) end = to;
+    while (start < end) {
+        size_t index = (start - from) / bucket;
+        // 64-bit: the end of the last bucket may lie beyond UINT32_MAX
+        uint64_t bucketEnd = (uint64_t)from + (uint64_t)(index + 1) * bucket;
+        uint32_t sliceEnd = end < bucketEnd ? end : (uint32_t)bucketEnd;
+        uint32_t seconds = sliceEnd - start;
+
+        out[index].runtime[mode] += seconds;
+        if (mode != AC_MODE_OFF) {
+            out[index].onSeconds += seconds;
+            out[index].setpointSeconds += temp * seconds;
+        }
+        start = sliceEnd;
+    }
+}
+
+size_t StateHistory::bucketCount(uint32_t from, uint32_t to, uint32_t bucket) {
+    if (bucket == 0 || from >= to || bucket > to - from) return 0;
+    return ((uint64_t)(to - from) + bucket - 1) / bucket;
+}
+
+size_t StateHistory::aggregate(uint32_t from, uint32_t to, uint32_t bucket, uint32_t now,
+                               HistoryBucket* out, size_t maxBuckets) const {
+    size_t count = bucketCount(from, to, bucket);
+    if (count == 0 || count > maxBuckets) return 0;
+
+    memset(out, 0, count * sizeof(HistoryBucket));
+    for (size_t i = 0; i < count; i++) {
+        out[i].start = from + i * bucket;
+    }
+
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t first = head - size();
+
+    // Walk commands oldest-first; each sent command holds until the next one
+    bool haveState = false;
+    uint8_t mode = AC_MODE_OFF;
+    uint8_t temp = 0;
+    uint32_t since = 0;
+    for (uint32_t i = first; i != head; i++) {
+        const HistoryRecord& record = _records[i % HISTORY_CAPACITY];
+
+        if (record.time >= from && record.time < to) {
+            HistoryBucket& b = out[(record.time - from) / bucket];
+            b.commands++;
+            if (!record.sent()) b.suppressed++;
+        }
+        if (!record.sent() || record.mode() > AC_MODE_MAX) continue;
+
+        if (haveState && record.time > since) {
+            addInterval(since, record.time, mode, temp, from, to, bucket, out);
+        }
+        mode = record.mode();
+        temp = record.temp;
+        since = record.time;
+        haveState = true;
+    }
+    if (haveState && now > since) {
+        addInterval(since, now, mode, temp, from, to, bucket, out);
+    }
+
+    return count;
+}
+
+// ===== PERSISTENCE =====
+
+bool StateHistory::checkpoint() {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (!_storageReady || head == _checkpointHead) return false;
+
+    File file = LittleFS.open(HISTORY_FILE, "w");
+    if (!file) {
+        Serial.println("Failed to open history checkpoint");
+        return false;
+    }
+
+    HistoryFileHeader header = {HISTORY_MAGIC, HISTORY_CAPACITY, head};
+    file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const uint8_t*>(_records), sizeof(_records));
+    file.close();
+
+    _checkpointHead = head;
+    return true;
+}
+
+void StateHistory::restore() {
+    File file = LittleFS.open(HISTORY_FILE, "r");
+    if (!file) return;
+
+    HistoryFileHeader header;
+    bool valid = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 header.magic == HISTORY_MAGIC && header.capacity == HISTORY_CAPACITY &&
+                 file.read(reinterpret_cast<uint8_t*>(_records), sizeof(_records)) == sizeof(_records);
+    file.close();
+
+    if (!valid) {
+        memset(_records, 0, sizeof(_records));
+        Serial.println("Ignoring incompatible history checkpoint");
+        return;
+    }
+
+    _head.store(header.head, std::memory_order_relaxed);
+    _checkpointHead = header.head;
+    Serial.printf("Restored %u history records\n", size());
+}
@@ -0,0 +1,79 @@
+#ifndef STATE_HISTORY_H
+#define STATE_HISTORY_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Where a recorded command came from
+enum HistorySource : uint8_t {
+    HISTORY_SOURCE_HTTP = 0,     // /set
+    HISTORY_SOURCE_GROUP = 1,    // Fanned out by a peer (or to our own group)
+    HISTORY_SOURCE_API = 2,      // POST /api/ac
+    HISTORY_SOURCE_SCENE = 3,    // Step of a stored scene
+    HISTORY_SOURCE_REMOTE = 4,   // Physical remote, seen by the IR receiver
+    HISTORY_SOURCE_THERMOSTAT = 5 // On-device thermostat
+};
+
+// One command, packed into 8 bytes
+struct __attribute__((packed)) HistoryRecord {
+    uint32_t time;      // Unix seconds (boot-relative until NTP has synced)
+    uint8_t model;
+    uint8_t temp;
+    uint8_t flags;      // mode:3 | fan:3 | swing:1 | sent:1
+    uint8_t source;
+
+    uint8_t mode() const { return flags & 0x07; }
+    uint8_t fan() const { return (flags >> 3) & 0x07; }
+    bool swing() const { return flags & 0x40; }
+    bool sent() const { return flags & 0x80; }
+};
+
+// Aggregates for one time bucket
+struct HistoryBucket {
+    uint32_t start;
+    uint16_t commands;
+    uint16_t suppressed;
+    uint32_t runtime[AC_MODE_MAX + 1];  // Seconds spent in each mode
+    uint32_t onSeconds;
+    uint32_t setpointSeconds;           // Sum of setpoint * seconds while on
+};
+
+// Fixed-memory ring of recent commands.
+// append() is a single atomic index bump plus an 8-byte store, so the
+// transmit path never waits on a lock; the ring is checkpointed to flash
+// periodically and restored at boot.
+class StateHistory {
+public:
+    StateHistory();
+
+    void begin();
+    void append(HistorySource source, int model, int mode, int temp, int fan, bool swing, bool sent);
+
+    // Buckets needed for [from, to), or 0 if the range is empty or shorter than one bucket
+    static size_t bucketCount(uint32_t from, uint32_t to, uint32_t bucket);
+
+    // Aggregate [from, to) into buckets of `bucket` seconds; returns bucket count
+    size_t aggregate(uint32_t from, uint32_t to, uint32_t bucket, uint32_t now,
+                     HistoryBucket* out, size_t maxBuckets) const;
+
+    // Write the ring to flash if anything was appended since the last checkpoint
+    bool checkpoint();
+
+    size_t size() const;
+    size_t capacity() const { return HISTORY_CAPACITY; }
+    static uint32_t now();
+
+private:
+    HistoryRecord _records[HISTORY_CAPACITY];
+    std::atomic<uint32_t> _head;
+    uint32_t _checkpointHead;
+    bool _storageReady;
+
+    void restore();
+};
+
+extern StateHistory stateHistory;
+
+#endif // STATE_HISTORY_H
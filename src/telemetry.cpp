@@ -0,0 +1,204 @@
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <string.h>
+#include "telemetry.h"
+
+#define TELEMETRY_MAGIC 0x544c4d31  // "TLM1"
+
+// Layout shared by RTC memory and the NVS checkpoint
+struct TelemetryState {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t bootCount;
+    uint32_t lifetimeMinFreeHeap;
+    TelemetrySession session;
+};
+
+// Not cleared by the startup code, so it keeps its contents across every
+// reset except power-on
+RTC_NOINIT_ATTR static TelemetryState rtcState;
+
+Telemetry telemetry;
+
+static void copyName(char* dest, const char* src) {
+    strncpy(dest, src, TELEMETRY_NAME_MAX);
+    dest[TELEMETRY_NAME_MAX] = '\0';
+}
+
+Telemetry::Telemetry()
+    : _previousSource(TELEMETRY_SOURCE_NONE), _dirty(false), _lastTick(0), _lastSample(0),
+      _lastTrend(0), _intervalLargest(UINT32_MAX) {
+    memset(&_previous, 0, sizeof(_previous));
+    _lastHandler[0] = '\0';
+}
+
+void Telemetry::begin() {
+    _prefs.begin("telemetry", false);
+
+    if (rtcState.magic == TELEMETRY_MAGIC && rtcState.size == sizeof(TelemetryState)) {
+        _previousSource = TELEMETRY_SOURCE_RTC;
+    } else {
+        TelemetryState saved;
+        size_t bytes = _prefs.getBytes("state", &saved, sizeof(saved));
+        if (bytes == sizeof(saved) && saved.magic == TELEMETRY_MAGIC && saved.size == sizeof(TelemetryState)) {
+            rtcState = saved;
+            _previousSource = TELEMETRY_SOURCE_NVS;
+        } else {
+            memset(&rtcState, 0, sizeof(rtcState));
+            rtcState.magic = TELEMETRY_MAGIC;
+            rtcState.size = sizeof(TelemetryState);
+            rtcState.lifetimeMinFreeHeap = UINT32_MAX;
+            _previousSource = TELEMETRY_SOURCE_NONE;
+        }
+    }
+
+    _previous = rtcState.session;
+    rtcState.bootCount++;
+
+    TelemetrySession& session = rtcState.session;
+    memset(&session, 0, sizeof(session));
+    session.resetReason = esp_reset_reason();
+    session.minFreeHeap = ESP.getFreeHeap();
+
+    Serial.printf("Boot #%u after %s reset", rtcState.bootCount, resetReasonName(session.resetReason));
+    if (_previousSource != TELEMETRY_SOURCE_NONE && _previous.activeHandler[0] != '\0') {
+        Serial.printf(" (was in '%s')", _previous.activeHandler);
+    }
+    Serial.println();
+
+    _dirty = true;
+}
+
+const TelemetrySession& Telemetry::current() const {
+    return rtcState.session;
+}
+
+uint32_t Telemetry::bootCount() const {
+    return rtcState.bootCount;
+}
+
+uint32_t Telemetry::lifetimeMinFreeHeap() const {
+    return rtcState.lifetimeMinFreeHeap;
+}
+
+// ===== SAMPLING =====
+
+// Called once per loop pass; the gap between calls is the loop stall
+void Telemetry::loopTick() {
+    unsigned long now = millis();
+    TelemetrySession& session = rtcState.session;
+
+    if (_lastTick != 0 && now - _lastTick > session.maxLoopStallMs) {
+        session.maxLoopStallMs = now - _lastTick;
+        copyName(session.stallHandler, _lastHandler);
+        _dirty = true;
+    }
+    _lastTick = now;
+
+    if (now - _lastSample >= TELEMETRY_SAMPLE_INTERVAL_MS) {
+        _lastSample = now;
+        sample(now);
+    }
+}
+
+void Telemetry::sample(unsigned long now) {
+    TelemetrySession& session = rtcState.session;
+    session.uptimeS = now / 1000;
+
+    uint32_t minFree = ESP.getMinFreeHeap();
+    if (minFree < session.minFreeHeap) session.minFreeHeap = minFree;
+    if (minFree < rtcState.lifetimeMinFreeHeap) rtcState.lifetimeMinFreeHeap = minFree;
+
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (largest < _intervalLargest) _intervalLargest = largest;
+
+    if (now - _lastTrend >= TELEMETRY_TREND_INTERVAL_MS || session.trendCount == 0) {
+        _lastTrend = now;
+        session.largestBlock[session.trendHead] = _intervalLargest;
+        session.trendHead = (session.trendHead + 1) % TELEMETRY_TREND_POINTS;
+        if (session.trendCount < TELEMETRY_TREND_POINTS) session.trendCount++;
+        _intervalLargest = UINT32_MAX;
+        _dirty = true;
+    }
+}
+
+// ===== EVENTS =====
+
+void Telemetry::endHandler(const char* name, uint32_t ms) {
+    TelemetrySession& session = rtcState.session;
+    TelemetryHandlerRecord& record = session.handlers[session.handlerHead];
+    copyName(record.name, name);
+    record.ms = ms > 0xffff ? 0xffff : ms;
+    record.at = millis() / 1000;
+    session.handlerHead = (session.handlerHead + 1) % TELEMETRY_HANDLER_HISTORY;
+    if (session.handlerCount < TELEMETRY_HANDLER_HISTORY) session.handlerCount++;
+
+    copyName(_lastHandler, name);
+    _dirty = true;
+}
+
+const char* Telemetry::activeHandler() const {
+    return rtcState.session.activeHandler;
+}
+
+void Telemetry::setActiveHandler(const char* name) {
+    copyName(rtcState.session.activeHandler, name);
+}
+
+void Telemetry::recordWifiOutage(uint32_t ms) {
+    rtcState.session.wifiOutages++;
+    rtcState.session.wifiOutageMs += ms;
+    _dirty = true;
+}
+
+void Telemetry::countCommand(bool sent) {
+    if (sent) {
+        rtcState.session.commandsSent++;
+    } else {
+        rtcState.session.commandsFailed++;
+    }
+    _dirty = true;
+}
+
+void Telemetry::countRejected() {
+    rtcState.session.commandsRejected++;
+    _dirty = true;
+}
+
+// ===== PERSISTENCE =====
+
+bool Telemetry::checkpoint() {
+    if (!_dirty) return false;
+    _dirty = false;
+    return _prefs.putBytes("state", &rtcState, sizeof(rtcState)) == sizeof(rtcState);
+}
+
+const char* Telemetry::resetReasonName(uint8_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON: return "power_on";
+        case ESP_RST_EXT: return "external";
+        case ESP_RST_SW: return "software";
+        case ESP_RST_PANIC: return "panic";
+        case ESP_RST_INT_WDT: return "interrupt_watchdog";
+        case ESP_RST_TASK_WDT: return "task_watchdog";
+        case ESP_RST_WDT: return "watchdog";
+        case ESP_RST_DEEPSLEEP: return "deep_sleep";
+        case ESP_RST_BROWNOUT: return "brownout";
+        case ESP_RST_SDIO: return "sdio";
+        default: return "unknown";
+    }
+}
+
+// ===== SCOPE =====
+
+TelemetryScope::TelemetryScope(const char* name) : _name(name), _start(millis()) {
+    copyName(_outer, telemetry.activeHandler());
+    telemetry.setActiveHandler(name);
+}
+
+TelemetryScope::~TelemetryScope() {
+    telemetry.endHandler(_name, millis() - _start);
+    telemetry.setActiveHandler(_outer);
+}
@@ -0,0 +1,100 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Preferences.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// One completed handler run
+struct TelemetryHandlerRecord {
+    char name[TELEMETRY_NAME_MAX + 1];
+    uint16_t ms;            // Duration (saturates at 65535)
+    uint32_t at;            // Uptime in seconds when it finished
+};
+
+// Everything known about one boot session
+struct TelemetrySession {
+    uint32_t uptimeS;
+    uint8_t resetReason;                        // esp_reset_reason_t that started the session
+    char activeHandler[TELEMETRY_NAME_MAX + 1]; // Non-empty while a handler runs
+    char stallHandler[TELEMETRY_NAME_MAX + 1];  // Last handler before the longest stall
+    uint32_t maxLoopStallMs;
+    uint32_t minFreeHeap;
+    uint32_t largestBlock[TELEMETRY_TREND_POINTS];  // Worst value per trend interval
+    uint8_t trendHead;
+    uint8_t trendCount;
+    uint16_t wifiOutages;
+    uint32_t wifiOutageMs;
+    uint32_t commandsSent;
+    uint32_t commandsFailed;
+    uint32_t commandsRejected;
+    TelemetryHandlerRecord handlers[TELEMETRY_HANDLER_HISTORY];
+    uint8_t handlerHead;
+    uint8_t handlerCount;
+};
+
+enum TelemetrySource : uint8_t {
+    TELEMETRY_SOURCE_NONE = 0,  // First boot or both copies lost
+    TELEMETRY_SOURCE_RTC = 1,   // Survived in RTC memory (software reset, watchdog, panic)
+    TELEMETRY_SOURCE_NVS = 2    // Last flash checkpoint (power loss, brownout)
+};
+
+// Performance and crash context that outlives a reset.
+// The live block sits in RTC memory, which keeps its contents through
+// software, watchdog and panic resets, so the previous session can be
+// reported after any of those; a periodic NVS checkpoint covers power loss.
+class Telemetry {
+public:
+    Telemetry();
+
+    void begin();
+    void loopTick();
+    bool checkpoint();
+
+    // Handler being run right now (reported as crash context) and
+    // completed runs (kept as a short history)
+    void setActiveHandler(const char* name);
+    const char* activeHandler() const;
+    void endHandler(const char* name, uint32_t ms);
+
+    void recordWifiOutage(uint32_t ms);
+    void countCommand(bool sent);
+    void countRejected();
+
+    const TelemetrySession& current() const;
+    const TelemetrySession& previous() const { return _previous; }
+    TelemetrySource previousSource() const { return _previousSource; }
+    uint32_t bootCount() const;
+    uint32_t lifetimeMinFreeHeap() const;
+    static const char* resetReasonName(uint8_t reason);
+
+private:
+    TelemetrySession _previous;
+    TelemetrySource _previousSource;
+    Preferences _prefs;
+    bool _dirty;
+    unsigned long _lastTick;
+    unsigned long _lastSample;
+    unsigned long _lastTrend;
+    uint32_t _intervalLargest;
+    char _lastHandler[TELEMETRY_NAME_MAX + 1];
+
+    void sample(unsigned long now);
+};
+
+extern Telemetry telemetry;
+
+// Marks a handler as running for its scope; nests by restoring the outer name
+class TelemetryScope {
+public:
+    explicit TelemetryScope(const char* name);
+    ~TelemetryScope();
+
+private:
+    const char* _name;
+    char _outer[TELEMETRY_NAME_MAX + 1];
+    unsigned long _start;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,157 @@
+#include <string.h>
+#include "thermostat.h"
+
+Thermostat::Thermostat()
+    : _settings(defaults()), _temperature(0), _readingAt(0), _haveReading(false), _running(false),
+      _changedAt(0), _holding(false), _issuedKnown(false), _readings(0), _commands(0),
+      _cycles(0), _held(0) {
+    memset(&_issued, 0, sizeof(_issued));
+}
+
+ThermostatSettings Thermostat::defaults() {
+    ThermostatSettings settings;
+    settings.mode = THERMOSTAT_OFF;
+    settings.target = THERMOSTAT_DEFAULT_TARGET;
+    settings.hysteresis = THERMOSTAT_DEFAULT_HYSTERESIS;
+    settings.minOnMs = THERMOSTAT_DEFAULT_MIN_ON_MS;
+    settings.minOffMs = THERMOSTAT_DEFAULT_MIN_OFF_MS;
+    settings.fan = AC_FAN_MIN;
+    settings.swing = false;
+    return settings;
+}
+
+bool Thermostat::validSettings(const ThermostatSettings& settings) {
+    return settings.mode <= THERMOSTAT_HEAT &&
+           settings.target >= AC_TEMP_MIN * 10 && settings.target <= AC_TEMP_MAX * 10 &&
+           settings.hysteresis >= 1 && settings.hysteresis <= THERMOSTAT_MAX_HYSTERESIS &&
+           settings.minOnMs <= THERMOSTAT_MAX_MIN_TIME_MS && settings.minOffMs <= THERMOSTAT_MAX_MIN_TIME_MS &&
+           settings.fan >= AC_FAN_MIN && settings.fan <= AC_FAN_MAX;
+}
+
+bool Thermostat::sameSettings(const ThermostatSettings& a, const ThermostatSettings& b) {
+    return a.mode == b.mode && a.target == b.target && a.hysteresis == b.hysteresis && a.minOnMs == b.minOnMs &&
+           a.minOffMs == b.minOffMs && a.fan == b.fan && a.swing == b.swing;
+}
+
+// ===== CONFIGURATION =====
+
+void Thermostat::configure(const ThermostatSettings& settings, const ThermostatCommand& unit) {
+    bool wasEnabled = enabled();
+    bool controlling = wasEnabled && _running;
+    _settings = settings;
+    _holding = false;
+    if (!enabled()) {
+        // Switching the thermostat off stops the unit only if it was running it
+        _running = controlling;
+        return;
+    }
+    // Still in control: what we last commanded is more current than the
+    // shadow state, which may lag behind a queued command
+    if (wasEnabled && _issuedKnown) return;
+
+    // Start from what the unit is actually doing. The last start/stop time
+    // is kept, so re-enabling cannot be used to skip a minimum time.
+    _issued = unit;
+    _issuedKnown = true;
+    _running = unit.mode != AC_MODE_OFF;
+}
+
+void Thermostat::manualOverride() {
+    _settings.mode = THERMOSTAT_OFF;
+    _running = false;
+    _issuedKnown = false;
+    _holding = false;
+}
+
+void Thermostat::reportTemperature(int16_t tenths, uint32_t now) {
+    _temperature = tenths;
+    _readingAt = now;
+    _haveReading = true;
+    _readings++;
+}
+
+bool Thermostat::hasReading(uint32_t now) const {
+    return _haveReading && now - _readingAt < THERMOSTAT_STALE_MS;
+}
+
+// ===== CONTROL =====
+
+// Whether the room needs the unit, ignoring minimum times
+bool Thermostat::demand(uint32_t now) const {
+    // Without a recent reading the safe choice is to stop
+    if (!hasReading(now)) return false;
+
+    int16_t high = _settings.target + _settings.hysteresis;
+    int16_t low = _settings.target - _settings.hysteresis;
+    if (_settings.mode == THERMOSTAT_COOL) {
+        if (_temperature >= high) return true;
+        if (_temperature <= low) return false;
+    } else {
+        if (_temperature <= low) return true;
+        if (_temperature >= high) return false;
+    }
+    // Inside the band: keep doing what we are doing
+    return _running;
+}
+
+ThermostatCommand Thermostat::desired(bool run) const {
+    ThermostatCommand command;
+    command.mode = !run ? AC_MODE_OFF : _settings.mode == THERMOSTAT_HEAT ? AC_MODE_HEAT : AC_MODE_COOL;
+    int temp = (_settings.target + 5) / 10;
+    command.temp = temp < AC_TEMP_MIN ? AC_TEMP_MIN : temp > AC_TEMP_MAX ? AC_TEMP_MAX : temp;
+    command.fan = _settings.fan;
+    command.swing = _settings.swing;
+    return command;
+}
+
+static bool sameCommand(const ThermostatCommand& a, const ThermostatCommand& b) {
+    if (a.mode != b.mode) return false;
+    // Setpoint, fan and swing do not matter while the unit is off
+    return a.mode == AC_MODE_OFF || (a.temp == b.temp && a.fan == b.fan && a.swing == b.swing);
+}
+
+bool Thermostat::update(uint32_t now, ThermostatCommand& command) {
+    if (!enabled()) {
+        // Switched off through the API while running: stop the unit
+        if (!_running) return false;
+        command = desired(false);
+        return true;
+    }
+
+    bool run = demand(now);
+    uint32_t minimum = _running ? _settings.minOnMs : _settings.minOffMs;
+    if (run != _running && now - _changedAt < minimum) {
+        if (!_holding) {
+            _holding = true;
+            _held++;
+        }
+        run = _running;
+    } else {
+        _holding = false;
+    }
+
+    ThermostatCommand next = desired(run);
+    if (_issuedKnown && sameCommand(next, _issued)) return false;
+    command = next;
+    return true;
+}
+
+void Thermostat::markIssued(const ThermostatCommand& command, uint32_t now) {
+    bool run = command.mode != AC_MODE_OFF;
+    if (run != _running) {
+        _changedAt = now;
+        if (run) _cycles++;
+    }
+    _running = run;
+    _issued = command;
+    _issuedKnown = true;
+    _holding = false;
+    _commands++;
+}
+
+uint32_t Thermostat::holdRemainingMs(uint32_t now) const {
+    if (!_holding) return 0;
+    uint32_t minimum = _running ? _settings.minOnMs : _settings.minOffMs;
+    uint32_t elapsed = now - _changedAt;
+    return elapsed < minimum ? minimum - elapsed : 0;
+}
@@ -0,0 +1,101 @@
+#ifndef THERMOSTAT_H
+#define THERMOSTAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+enum ThermostatMode : uint8_t {
+    THERMOSTAT_OFF = 0,         // Not controlling the unit
+    THERMOSTAT_COOL = 1,
+    THERMOSTAT_HEAT = 2
+};
+
+// Temperatures are in tenths of a degree Celsius, times in ms
+struct ThermostatSettings {
+    uint8_t mode;               // ThermostatMode
+    int16_t target;
+    uint16_t hysteresis;        // Start beyond target +/- hysteresis, stop beyond the other side
+    uint32_t minOnMs;           // Shortest run once started
+    uint32_t minOffMs;          // Shortest rest once stopped
+    uint8_t fan;
+    bool swing;
+};
+
+// A command for ACController (mode is an AC_MODE_* value)
+struct ThermostatCommand {
+    uint8_t mode;
+    uint8_t temp;
+    uint8_t fan;
+    bool swing;
+};
+
+// On-device control loop for room temperature.
+// Readings are pushed in (HTTP or a local sensor); update() decides whether
+// the unit should run, with a hysteresis band around the target and minimum
+// on/off times to protect the compressor. A command is only produced when
+// it differs from the last one this thermostat issued, so repeated readings
+// or near-identical targets cause no IR traffic. Pure C++ with
+// caller-supplied timestamps so it can be exercised on the host.
+class Thermostat {
+public:
+    Thermostat();
+
+    static ThermostatSettings defaults();
+    static bool validSettings(const ThermostatSettings& settings);
+    static bool sameSettings(const ThermostatSettings& a, const ThermostatSettings& b);
+
+    // Apply new settings. `unit` is what the unit is currently doing, so
+    // enabling the thermostat only sends a command if a change is needed.
+    void configure(const ThermostatSettings& settings, const ThermostatCommand& unit);
+    const ThermostatSettings& settings() const { return _settings; }
+    bool enabled() const { return _settings.mode != THERMOSTAT_OFF; }
+
+    // Someone else commanded the unit: stop controlling it without sending anything
+    void manualOverride();
+
+    void reportTemperature(int16_t tenths, uint32_t now);
+    bool hasReading(uint32_t now) const;
+    int16_t temperature() const { return _temperature; }
+    uint32_t readingAgeMs(uint32_t now) const { return now - _readingAt; }
+
+    // Returns true (and fills `command`) when the unit must be switched.
+    // Call markIssued() once the command was accepted; until then the
+    // same command is returned again.
+    bool update(uint32_t now, ThermostatCommand& command);
+    void markIssued(const ThermostatCommand& command, uint32_t now);
+
+    // State
+    bool running() const { return _running; }
+    uint32_t holdRemainingMs(uint32_t now) const;
+
+    // Statistics
+    uint32_t readings() const { return _readings; }
+    uint32_t commands() const { return _commands; }
+    uint32_t cycles() const { return _cycles; }
+    uint32_t held() const { return _held; }
+
+private:
+    ThermostatSettings _settings;
+
+    int16_t _temperature;
+    uint32_t _readingAt;
+    bool _haveReading;
+
+    bool _running;              // Unit is (believed to be) running for us
+    uint32_t _changedAt;        // Last start or stop. Boot (0) counts as one: the unit may have
+                                // switched just before a crash or OTA restart
+    bool _holding;              // A start/stop is waiting for the minimum time
+    ThermostatCommand _issued;
+    bool _issuedKnown;
+
+    uint32_t _readings;
+    uint32_t _commands;
+    uint32_t _cycles;
+    uint32_t _held;
+
+    bool demand(uint32_t now) const;
+    ThermostatCommand desired(bool run) const;
+};
+
+#endif // THERMOSTAT_H
@@ -0,0 +1,388 @@
+// Generated by make_tadiran_captures.py - do not edit
+#pragma once
+#include <stdint.h>
+#include <IRremoteESP8266.h>
+
+// Power off
+static const uint16_t CAPTURE_OFF[263] = {
+    8106, 3926, 1680, 496, 620, 1540, 616, 1586, 604, 1550, 650, 1572,
+    580, 1536, 620, 1550, 652, 1578, 598, 1572, 578, 1562, 1688, 514,
+    604, 1550, 1686, 462, 626, 1562, 634, 1508, 622, 1536, 606, 1580,
+    648, 1554, 622, 1552, 622, 1558, 1674, 446, 1666, 460, 582, 1540,
+    578, 1546, 640, 1536, 620, 1576, 628, 1532, 616, 1580, 588, 1516,
+    652, 1564, 582, 1550, 616, 1562, 640, 1586, 616, 1518, 576, 1558,
+    606, 1542, 622, 1520, 628, 1582, 644, 1570, 584, 1556, 608, 1586,
+    654, 1530, 608, 1508, 654, 1570, 586, 1558, 614, 1544, 1704, 456,
+    1696, 508, 584, 1552, 602, 1568, 638, 1510, 626, 1564, 598, 1552,
+    654, 1580, 646, 1582, 632, 1546, 1656, 466, 622, 1534, 1660, 478,
+    574, 1542, 1672, 494, 602, 1546, 592, 1536, 650, 1578, 1692, 30894,
+    8070, 3916, 1682, 504, 654, 1582, 626, 1514, 634, 1518, 612, 1550,
+    606, 1534, 644, 1568, 586, 1550, 612, 1522, 602, 1566, 1702, 466,
+    622, 1564, 1702, 456, 578, 1556, 574, 1574, 620, 1514, 592, 1548,
+    650, 1544, 604, 1520, 632, 1534, 1714, 512, 1726, 508, 652, 1518,
+    588, 1532, 598, 1510, 578, 1584, 640, 1552, 580, 1534, 610, 1562,
+    574, 1530, 610, 1564, 598, 1556, 622, 1582, 654, 1566, 654, 1576,
+    574, 1546, 594, 1552, 588, 1516, 616, 1524, 622, 1544, 606, 1540,
+    602, 1570, 624, 1514, 618, 1568, 652, 1554, 576, 1526, 1688, 464,
+    1656, 484, 626, 1532, 608, 1550, 610, 1566, 634, 1520, 636, 1528,
+    648, 1542, 616, 1518, 652, 1548, 1648, 442, 590, 1578, 1648, 494,
+    574, 1518, 1700, 514, 612, 1536, 652, 1566, 642, 1554, 1686,
+};
+
+// Cool 24, fan 2
+static const uint16_t CAPTURE_COOL_24_FAN2[263] = {
+    8040, 3948, 1650, 500, 632, 1582, 584, 1542, 592, 1558, 650, 1528,
+    614, 1512, 592, 1578, 638, 1550, 1660, 464, 632, 1522, 642, 1544,
+    640, 1526, 1656, 452, 1708, 468, 638, 1516, 586, 1514, 650, 1528,
+    648, 1588, 618, 1562, 634, 1548, 1690, 470, 1714, 446, 614, 1568,
+    654, 1566, 634, 1530, 644, 1564, 630, 1544, 624, 1566, 604, 1526,
+    592, 1566, 612, 1586, 600, 1568, 640, 1582, 648, 1512, 632, 1584,
+    636, 1586, 590, 1560, 606, 1564, 576, 1538, 636, 1576, 612, 1544,
+    642, 1532, 590, 1562, 596, 1560, 1662, 450, 1702, 482, 622, 1512,
+    642, 1564, 628, 1546, 650, 1580, 598, 1518, 614, 1572, 644, 1574,
+    618, 1556, 592, 1560, 632, 1540, 1662, 450, 1654, 458, 646, 1560,
+    1706, 472, 592, 1564, 608, 1536, 598, 1568, 580, 1572, 1698, 30902,
+    8088, 3934, 1726, 462, 616, 1578, 574, 1580, 630, 1514, 578, 1538,
+    642, 1516, 578, 1524, 630, 1508, 1652, 474, 574, 1534, 626, 1586,
+    576, 1524, 1648, 458, 1676, 508, 614, 1556, 646, 1582, 590, 1544,
+    580, 1562, 634, 1554, 582, 1538, 1652, 442, 1688, 474, 628, 1510,
+    586, 1574, 598, 1534, 590, 1582, 642, 1534, 634, 1526, 578, 1542,
+    612, 1534, 584, 1548, 610, 1574, 654, 1522, 580, 1574, 592, 1542,
+    600, 1524, 594, 1544, 622, 1572, 616, 1536, 636, 1574, 582, 1540,
+    578, 1536, 622, 1552, 636, 1546, 1672, 494, 1650, 446, 638, 1544,
+    628, 1526, 600, 1566, 612, 1572, 628, 1522, 644, 1582, 620, 1562,
+    578, 1544, 592, 1542, 580, 1556, 1654, 468, 1658, 454, 642, 1520,
+    1720, 500, 616, 1508, 610, 1526, 608, 1552, 648, 1548, 1704,
+};
+
+// Heat 24, fan 2
+static const uint16_t CAPTURE_HEAT_24_FAN2[263] = {
+    8086, 3928, 1710, 484, 604, 1528, 632, 1520, 576, 1548, 618, 1572,
+    592, 1552, 600, 1530, 576, 1528, 626, 1560, 1688, 454, 622, 1528,
+    618, 1546, 1680, 490, 1724, 460, 624, 1572, 642, 1526, 590, 1568,
+    600, 1570, 610, 1572, 638, 1550, 1688, 480, 1664, 494, 630, 1582,
+    638, 1514, 636, 1558, 624, 1572, 652, 1546, 574, 1564, 604, 1522,
+    614, 1526, 576, 1548, 586, 1578, 582, 1522, 618, 1578, 638, 1540,
+    634, 1534, 584, 1508, 604, 1544, 638, 1568, 608, 1520, 592, 1534,
+    584, 1580, 620, 1564, 592, 1526, 1688, 482, 1684, 486, 590, 1574,
+    610, 1516, 582, 1524, 648, 1514, 592, 1582, 582, 1548, 574, 1546,
+    590, 1524, 614, 1526, 618, 1522, 594, 1576, 650, 1574, 1660, 444,
+    1668, 512, 618, 1514, 640, 1578, 640, 1572, 586, 1552, 1662, 30964,
+    8108, 3890, 1700, 472, 596, 1572, 638, 1566, 574, 1546, 576, 1512,
+    620, 1510, 634, 1564, 586, 1534, 646, 1586, 1670, 486, 632, 1584,
+    620, 1536, 1724, 512, 1666, 442, 616, 1540, 588, 1588, 574, 1518,
+    596, 1514, 590, 1570, 576, 1512, 1718, 490, 1684, 480, 622, 1554,
+    586, 1552, 644, 1510, 650, 1518, 612, 1556, 630, 1580, 604, 1586,
+    644, 1516, 594, 1542, 622, 1558, 640, 1518, 616, 1558, 618, 1522,
+    638, 1510, 586, 1536, 584, 1530, 646, 1580, 638, 1572, 584, 1566,
+    620, 1548, 614, 1562, 608, 1580, 1652, 484, 1718, 512, 612, 1510,
+    574, 1566, 636, 1572, 632, 1536, 654, 1566, 616, 1576, 612, 1508,
+    652, 1512, 612, 1528, 626, 1514, 650, 1570, 606, 1510, 1708, 492,
+    1722, 458, 626, 1544, 618, 1534, 642, 1508, 616, 1568, 1654,
+};
+
+// Fan only, fan 2
+static const uint16_t CAPTURE_CIRCULATE_24_FAN2[263] = {
+    8048, 3914, 1658, 480, 606, 1540, 642, 1522, 618, 1584, 598, 1568,
+    604, 1564, 610, 1542, 614, 1568, 1652, 464, 1712, 468, 620, 1572,
+    592, 1528, 1722, 514, 1678, 494, 588, 1552, 576, 1520, 588, 1554,
+    650, 1556, 576, 1514, 604, 1518, 1652, 506, 1702, 448, 642, 1568,
+    636, 1564, 652, 1572, 644, 1548, 626, 1526, 638, 1544, 588, 1552,
+    596, 1534, 600, 1540, 636, 1520, 648, 1524, 588, 1580, 616, 1532,
+    632, 1546, 576, 1508, 642, 1576, 654, 1518, 620, 1534, 620, 1548,
+    584, 1562, 580, 1544, 628, 1566, 1684, 514, 1688, 466, 620, 1538,
+    598, 1528, 640, 1542, 620, 1564, 630, 1538, 620, 1550, 606, 1576,
+    642, 1542, 594, 1582, 576, 1530, 1672, 450, 636, 1522, 1670, 480,
+    1726, 460, 632, 1550, 620, 1550, 630, 1564, 600, 1582, 1686, 30964,
+    8086, 3902, 1658, 480, 624, 1578, 648, 1526, 644, 1576, 652, 1574,
+    608, 1554, 654, 1532, 624, 1522, 1654, 512, 1700, 436, 614, 1520,
+    598, 1542, 1710, 454, 1690, 438, 642, 1514, 648, 1538, 630, 1524,
+    630, 1560, 612, 1510, 604, 1574, 1714, 508, 1656, 448, 642, 1544,
+    646, 1542, 646, 1544, 608, 1580, 616, 1526, 654, 1550, 610, 1576,
+    634, 1520, 618, 1510, 626, 1532, 650, 1536, 582, 1586, 606, 1544,
+    578, 1556, 622, 1574, 626, 1530, 574, 1564, 586, 1528, 610, 1560,
+    606, 1582, 612, 1540, 606, 1548, 1698, 502, 1728, 456, 602, 1508,
+    650, 1532, 652, 1518, 636, 1530, 644, 1544, 600, 1572, 624, 1512,
+    624, 1582, 604, 1524, 628, 1524, 1650, 446, 592, 1532, 1668, 514,
+    1654, 446, 590, 1550, 646, 1550, 596, 1556, 594, 1562, 1704,
+};
+
+// Dry 24, fan 2
+static const uint16_t CAPTURE_DRY_24_FAN2[263] = {
+    8054, 3894, 1652, 460, 600, 1542, 614, 1516, 578, 1516, 624, 1514,
+    628, 1522, 616, 1570, 578, 1580, 626, 1526, 642, 1532, 1678, 506,
+    636, 1582, 1688, 500, 1666, 498, 640, 1560, 622, 1560, 592, 1568,
+    626, 1570, 640, 1552, 626, 1588, 1694, 478, 1726, 436, 638, 1588,
+    616, 1584, 600, 1542, 644, 1530, 586, 1512, 588, 1554, 654, 1554,
+    632, 1556, 638, 1582, 592, 1562, 614, 1560, 638, 1588, 602, 1586,
+    588, 1566, 604, 1558, 614, 1508, 614, 1562, 626, 1566, 644, 1566,
+    632, 1584, 630, 1584, 610, 1532, 1662, 444, 1670, 436, 606, 1578,
+    582, 1552, 600, 1530, 594, 1556, 598, 1584, 620, 1580, 644, 1566,
+    652, 1578, 592, 1542, 634, 1584, 618, 1510, 1648, 442, 1686, 440,
+    1664, 484, 648, 1540, 596, 1530, 618, 1544, 576, 1518, 1658, 30964,
+    8060, 3962, 1654, 498, 602, 1576, 642, 1562, 582, 1572, 632, 1526,
+    642, 1564, 626, 1578, 630, 1514, 578, 1530, 638, 1556, 1658, 438,
+    620, 1520, 1728, 440, 1654, 446, 596, 1522, 636, 1536, 590, 1564,
+    602, 1512, 634, 1530, 614, 1574, 1706, 440, 1682, 510, 630, 1536,
+    598, 1554, 642, 1510, 614, 1584, 626, 1518, 582, 1526, 614, 1524,
+    650, 1544, 596, 1580, 620, 1542, 648, 1566, 650, 1532, 612, 1526,
+    618, 1516, 586, 1508, 652, 1574, 636, 1534, 634, 1542, 628, 1588,
+    620, 1534, 598, 1540, 616, 1550, 1660, 458, 1660, 464, 594, 1520,
+    580, 1582, 618, 1586, 596, 1564, 626, 1558, 598, 1574, 632, 1572,
+    602, 1524, 610, 1556, 600, 1534, 602, 1532, 1714, 462, 1728, 476,
+    1708, 478, 622, 1550, 636, 1566, 634, 1550, 652, 1558, 1648,
+};
+
+// Cool 24, fan 1
+static const uint16_t CAPTURE_COOL_24_FAN1[263] = {
+    8058, 3914, 1668, 470, 618, 1508, 628, 1550, 654, 1576, 588, 1528,
+    590, 1520, 614, 1580, 590, 1580, 1700, 450, 598, 1568, 578, 1550,
+    612, 1530, 632, 1538, 1714, 514, 580, 1572, 574, 1558, 634, 1538,
+    602, 1546, 580, 1518, 620, 1586, 1664, 450, 1664, 460, 618, 1516,
+    576, 1522, 652, 1566, 650, 1538, 614, 1572, 630, 1532, 608, 1584,
+    578, 1586, 652, 1568, 622, 1514, 642, 1584, 628, 1528, 622, 1508,
+    608, 1528, 634, 1580, 602, 1518, 586, 1564, 590, 1562, 644, 1518,
+    638, 1526, 616, 1548, 586, 1584, 1722, 444, 1666, 466, 582, 1538,
+    642, 1518, 652, 1552, 632, 1520, 630, 1540, 594, 1522, 606, 1554,
+    626, 1508, 600, 1534, 640, 1546, 616, 1518, 1684, 468, 654, 1558,
+    1710, 466, 644, 1534, 588, 1540, 630, 1578, 606, 1584, 1682, 30906,
+    8040, 3946, 1708, 446, 642, 1512, 648, 1528, 602, 1540, 644, 1528,
+    638, 1576, 594, 1568, 648, 1584, 1684, 478, 622, 1550, 606, 1576,
+    584, 1578, 602, 1542, 1676, 506, 584, 1564, 592, 1582, 650, 1544,
+    574, 1530, 610, 1510, 582, 1516, 1658, 438, 1706, 478, 650, 1510,
+    582, 1558, 642, 1508, 602, 1560, 634, 1576, 574, 1566, 652, 1512,
+    580, 1512, 646, 1540, 624, 1522, 620, 1552, 620, 1580, 622, 1546,
+    630, 1528, 590, 1570, 598, 1556, 634, 1534, 622, 1574, 624, 1530,
+    596, 1556, 604, 1532, 594, 1564, 1658, 450, 1724, 446, 648, 1586,
+    638, 1538, 630, 1574, 612, 1548, 592, 1536, 606, 1576, 592, 1546,
+    632, 1514, 652, 1544, 652, 1526, 610, 1538, 1668, 458, 626, 1516,
+    1672, 436, 584, 1580, 578, 1532, 590, 1520, 628, 1582, 1700,
+};
+
+// Cool 24, fan 3
+static const uint16_t CAPTURE_COOL_24_FAN3[263] = {
+    8098, 3970, 1684, 510, 594, 1564, 632, 1582, 624, 1534, 648, 1550,
+    630, 1584, 644, 1584, 630, 1568, 1702, 512, 604, 1556, 590, 1568,
+    638, 1534, 648, 1548, 596, 1516, 1694, 446, 578, 1554, 622, 1576,
+    616, 1576, 644, 1516, 642, 1586, 1726, 468, 1678, 490, 576, 1518,
+    584, 1586, 588, 1546, 638, 1512, 636, 1514, 632, 1566, 654, 1550,
+    642, 1536, 592, 1552, 600, 1530, 630, 1562, 586, 1582, 634, 1570,
+    592, 1564, 582, 1570, 580, 1568, 628, 1526, 642, 1562, 644, 1512,
+    638, 1586, 638, 1578, 610, 1584, 1702, 444, 1720, 478, 590, 1514,
+    652, 1534, 604, 1530, 636, 1530, 622, 1538, 652, 1520, 584, 1520,
+    584, 1548, 594, 1514, 632, 1566, 648, 1532, 592, 1562, 1684, 484,
+    1704, 472, 614, 1522, 588, 1518, 634, 1528, 644, 1564, 1684, 30922,
+    8098, 3948, 1658, 492, 644, 1558, 590, 1582, 588, 1544, 634, 1532,
+    610, 1550, 614, 1534, 626, 1514, 1672, 464, 628, 1560, 582, 1540,
+    608, 1554, 614, 1588, 616, 1510, 1672, 504, 640, 1550, 610, 1538,
+    642, 1584, 608, 1514, 642, 1550, 1656, 486, 1698, 434, 614, 1532,
+    594, 1512, 604, 1554, 592, 1554, 598, 1520, 578, 1520, 614, 1508,
+    576, 1526, 652, 1522, 620, 1580, 598, 1570, 624, 1578, 652, 1548,
+    610, 1552, 584, 1548, 642, 1566, 620, 1542, 588, 1562, 590, 1566,
+    602, 1574, 600, 1552, 584, 1570, 1720, 502, 1668, 502, 652, 1566,
+    610, 1534, 630, 1572, 604, 1528, 652, 1520, 578, 1510, 652, 1582,
+    632, 1548, 596, 1556, 646, 1558, 628, 1558, 626, 1566, 1690, 446,
+    1692, 448, 640, 1528, 628, 1522, 624, 1542, 598, 1570, 1710,
+};
+
+// Cool 24, fan 4
+static const uint16_t CAPTURE_COOL_24_FAN4[263] = {
+    8042, 3906, 1650, 498, 598, 1520, 606, 1532, 576, 1514, 602, 1522,
+    642, 1554, 642, 1544, 586, 1518, 1686, 434, 586, 1516, 654, 1586,
+    582, 1526, 1722, 452, 630, 1542, 1680, 512, 580, 1560, 604, 1512,
+    610, 1572, 590, 1578, 606, 1556, 1678, 464, 1650, 438, 648, 1580,
+    602, 1508, 616, 1524, 616, 1536, 626, 1542, 634, 1528, 638, 1578,
+    594, 1552, 620, 1560, 642, 1558, 588, 1562, 624, 1516, 608, 1510,
+    586, 1510, 606, 1544, 626, 1510, 628, 1538, 592, 1542, 618, 1530,
+    612, 1580, 596, 1512, 590, 1510, 1678, 454, 1658, 436, 636, 1578,
+    600, 1528, 636, 1580, 612, 1514, 622, 1514, 578, 1588, 584, 1562,
+    622, 1530, 598, 1568, 618, 1522, 1696, 478, 652, 1562, 1666, 510,
+    1714, 502, 642, 1580, 622, 1510, 646, 1566, 644, 1576, 1668, 30970,
+    8092, 3968, 1672, 486, 618, 1558, 592, 1508, 650, 1540, 644, 1562,
+    606, 1542, 626, 1582, 630, 1528, 1658, 438, 602, 1564, 582, 1556,
+    630, 1570, 1716, 470, 628, 1562, 1704, 510, 634, 1570, 600, 1568,
+    616, 1556, 610, 1580, 614, 1528, 1694, 464, 1662, 506, 598, 1520,
+    622, 1534, 610, 1552, 650, 1570, 580, 1574, 644, 1582, 608, 1508,
+    602, 1524, 640, 1562, 576, 1568, 654, 1520, 632, 1556, 634, 1526,
+    578, 1544, 652, 1584, 650, 1580, 638, 1548, 610, 1586, 620, 1524,
+    608, 1554, 590, 1518, 588, 1584, 1678, 442, 1668, 468, 606, 1520,
+    626, 1582, 636, 1542, 600, 1572, 622, 1514, 576, 1514, 616, 1510,
+    652, 1534, 586, 1550, 652, 1550, 1670, 470, 630, 1562, 1696, 478,
+    1674, 454, 628, 1530, 580, 1556, 646, 1552, 604, 1520, 1688,
+};
+
+// Cool 16, fan 1, swing
+static const uint16_t CAPTURE_COOL_16_SWING[263] = {
+    8076, 3918, 1678, 504, 586, 1516, 632, 1580, 636, 1552, 594, 1526,
+    592, 1586, 580, 1526, 576, 1516, 1674, 506, 594, 1586, 604, 1540,
+    630, 1552, 634, 1538, 1704, 454, 592, 1530, 654, 1562, 606, 1588,
+    628, 1576, 598, 1514, 584, 1540, 580, 1530, 1658, 500, 624, 1538,
+    592, 1558, 624, 1520, 588, 1530, 634, 1574, 650, 1524, 610, 1546,
+    632, 1580, 590, 1530, 608, 1568, 612, 1564, 646, 1528, 650, 1578,
+    638, 1546, 624, 1536, 640, 1514, 652, 1566, 616, 1542, 588, 1542,
+    592, 1564, 638, 1550, 630, 1534, 1688, 476, 1654, 498, 622, 1518,
+    576, 1586, 582, 1534, 616, 1542, 598, 1564, 584, 1538, 654, 1526,
+    588, 1538, 1664, 468, 1656, 452, 1702, 460, 644, 1574, 1690, 510,
+    630, 1512, 1700, 480, 626, 1524, 576, 1538, 626, 1526, 1718, 30948,
+    8088, 3912, 1660, 500, 632, 1540, 602, 1534, 634, 1536, 600, 1560,
+    606, 1512, 574, 1536, 590, 1574, 1706, 512, 616, 1578, 638, 1510,
+    648, 1546, 610, 1580, 1676, 482, 604, 1532, 638, 1508, 652, 1524,
+    648, 1542, 584, 1518, 580, 1578, 580, 1538, 1668, 512, 648, 1562,
+    620, 1516, 616, 1516, 624, 1556, 590, 1580, 636, 1564, 634, 1546,
+    582, 1578, 612, 1534, 594, 1524, 640, 1564, 582, 1544, 576, 1518,
+    582, 1550, 578, 1538, 614, 1534, 580, 1556, 590, 1530, 648, 1574,
+    602, 1574, 618, 1534, 644, 1542, 1678, 490, 1728, 436, 638, 1540,
+    654, 1576, 624, 1548, 614, 1516, 580, 1558, 620, 1570, 624, 1564,
+    640, 1510, 1718, 448, 1700, 450, 1718, 448, 582, 1580, 1678, 510,
+    638, 1516, 1714, 482, 624, 1534, 630, 1512, 652, 1580, 1656,
+};
+
+// Heat 30, fan 4
+static const uint16_t CAPTURE_HEAT_30_FAN4[263] = {
+    8068, 3946, 1676, 448, 632, 1556, 614, 1526, 584, 1566, 584, 1584,
+    580, 1552, 634, 1556, 642, 1554, 654, 1536, 1716, 514, 630, 1580,
+    582, 1550, 1658, 460, 604, 1562, 1662, 502, 640, 1570, 626, 1574,
+    578, 1562, 1710, 440, 1668, 458, 1710, 510, 1712, 510, 604, 1516,
+    638, 1548, 608, 1536, 590, 1584, 654, 1548, 634, 1540, 604, 1564,
+    612, 1562, 642, 1578, 634, 1532, 590, 1516, 576, 1582, 616, 1554,
+    644, 1512, 592, 1540, 626, 1554, 594, 1510, 634, 1522, 614, 1544,
+    606, 1572, 598, 1528, 610, 1538, 1686, 462, 1682, 502, 646, 1566,
+    610, 1548, 644, 1544, 608, 1588, 606, 1588, 634, 1528, 624, 1566,
+    612, 1512, 594, 1522, 628, 1518, 580, 1558, 1690, 486, 610, 1574,
+    1690, 448, 1650, 490, 652, 1510, 616, 1546, 622, 1578, 1708, 30936,
+    8032, 3906, 1684, 484, 576, 1582, 620, 1566, 586, 1512, 632, 1542,
+    616, 1522, 648, 1512, 594, 1536, 598, 1550, 1690, 464, 640, 1510,
+    630, 1530, 1674, 498, 578, 1510, 1670, 494, 588, 1518, 648, 1544,
+    606, 1564, 1654, 436, 1652, 498, 1678, 492, 1700, 514, 622, 1560,
+    620, 1566, 586, 1580, 574, 1538, 638, 1586, 574, 1562, 610, 1526,
+    606, 1536, 640, 1540, 594, 1580, 596, 1514, 632, 1570, 622, 1508,
+    608, 1516, 654, 1578, 626, 1550, 640, 1558, 582, 1544, 586, 1522,
+    654, 1566, 624, 1578, 590, 1562, 1714, 436, 1724, 510, 592, 1514,
+    644, 1568, 604, 1576, 594, 1540, 618, 1582, 600, 1532, 606, 1544,
+    604, 1566, 626, 1566, 614, 1536, 592, 1548, 1698, 444, 580, 1578,
+    1722, 474, 1686, 452, 598, 1568, 592, 1534, 606, 1580, 1654,
+};
+
+// Cool 25 with the checksum of cool 24
+static const uint16_t CAPTURE_BAD_CHECKSUM[263] = {
+    8104, 3934, 1726, 496, 650, 1514, 640, 1574, 648, 1558, 654, 1550,
+    594, 1530, 654, 1522, 608, 1576, 1664, 476, 646, 1540, 582, 1526,
+    606, 1552, 1652, 472, 1666, 492, 630, 1514, 586, 1582, 608, 1542,
+    1714, 436, 654, 1544, 636, 1512, 1696, 468, 1692, 474, 614, 1570,
+    610, 1516, 582, 1574, 638, 1580, 612, 1552, 582, 1558, 642, 1560,
+    612, 1582, 576, 1586, 616, 1576, 592, 1546, 602, 1524, 650, 1514,
+    598, 1582, 594, 1538, 618, 1508, 620, 1558, 614, 1578, 608, 1508,
+    614, 1536, 592, 1512, 628, 1554, 1692, 492, 1650, 492, 636, 1520,
+    638, 1574, 640, 1546, 640, 1512, 596, 1520, 626, 1580, 592, 1582,
+    638, 1556, 630, 1584, 614, 1534, 1686, 480, 1706, 490, 594, 1578,
+    1666, 490, 590, 1544, 612, 1546, 636, 1560, 628, 1512, 1692, 30944,
+    8056, 3908, 1726, 506, 582, 1584, 638, 1522, 630, 1534, 586, 1584,
+    624, 1508, 596, 1530, 578, 1548, 1706, 508, 648, 1548, 644, 1526,
+    624, 1586, 1708, 450, 1654, 512, 602, 1508, 654, 1518, 648, 1536,
+    1650, 478, 578, 1562, 602, 1556, 1708, 480, 1724, 446, 650, 1534,
+    630, 1552, 600, 1568, 584, 1522, 592, 1550, 614, 1522, 638, 1560,
+    638, 1520, 580, 1558, 650, 1540, 600, 1514, 650, 1572, 652, 1528,
+    628, 1566, 618, 1570, 604, 1528, 630, 1514, 582, 1584, 588, 1528,
+    588, 1558, 634, 1530, 632, 1512, 1684, 484, 1674, 492, 586, 1532,
+    576, 1536, 582, 1566, 592, 1522, 584, 1560, 612, 1522, 630, 1530,
+    630, 1508, 580, 1534, 596, 1548, 1690, 480, 1700, 496, 576, 1572,
+    1724, 506, 622, 1540, 612, 1534, 596, 1588, 596, 1550, 1676,
+};
+
+// Cool 24 cut short by a buffer overflow
+static const uint16_t CAPTURE_TRUNCATED[90] = {
+    8056, 3964, 1676, 476, 580, 1542, 654, 1574, 594, 1572, 618, 1582,
+    650, 1518, 612, 1582, 636, 1534, 1648, 468, 616, 1530, 594, 1510,
+    632, 1562, 1676, 468, 1692, 450, 614, 1532, 654, 1576, 642, 1556,
+    594, 1552, 584, 1574, 596, 1550, 1720, 500, 1678, 474, 652, 1546,
+    596, 1576, 644, 1544, 622, 1550, 586, 1558, 604, 1564, 624, 1568,
+    578, 1576, 616, 1564, 608, 1550, 578, 1538, 598, 1522, 592, 1530,
+    624, 1532, 648, 1566, 608, 1528, 616, 1574, 624, 1526, 586, 1550,
+    630, 1584, 580, 1574, 602, 1514,
+};
+
+// NEC TV remote, address 0x04 command 0x08 (not an A/C)
+static const uint16_t CAPTURE_NEC_TV[67] = {
+    9080, 4438, 620, 476, 618, 520, 620, 1650, 592, 526, 590, 524,
+    646, 458, 640, 488, 620, 494, 634, 1598, 642, 1602, 666, 528,
+    620, 1634, 664, 1640, 642, 1596, 604, 1646, 620, 1580, 618, 472,
+    664, 452, 606, 504, 640, 1654, 648, 494, 662, 500, 618, 524,
+    632, 482, 658, 1620, 652, 1654, 670, 1640, 602, 516, 590, 1650,
+    602, 1638, 662, 1658, 612, 1622, 658,
+};
+
+// Coolix B2 5F 40: cool 24, medium fan
+static const uint16_t CAPTURE_COOLIX_COOL_24[199] = {
+    4566, 4448, 630, 1592, 666, 508, 618, 1600, 656, 1624, 666, 526,
+    592, 506, 664, 1596, 626, 500, 642, 482, 602, 1620, 646, 524,
+    644, 476, 644, 1582, 652, 1638, 658, 472, 618, 1638, 652, 512,
+    654, 1618, 664, 520, 634, 1574, 668, 1570, 634, 1628, 614, 1588,
+    592, 1572, 666, 1600, 632, 460, 658, 1602, 596, 474, 614, 512,
+    602, 486, 668, 508, 654, 454, 666, 528, 664, 1586, 662, 526,
+    624, 530, 604, 452, 668, 482, 634, 492, 668, 496, 658, 1596,
+    640, 492, 602, 1628, 644, 1592, 632, 1592, 614, 1582, 642, 1648,
+    660, 1648, 628, 4996, 4526, 4428, 628, 1606, 618, 462, 660, 1612,
+    668, 1572, 634, 518, 594, 450, 668, 1650, 620, 500, 626, 498,
+    628, 1626, 650, 470, 648, 468, 654, 1604, 602, 1618, 638, 492,
+    622, 1624, 622, 510, 620, 1642, 624, 520, 626, 1648, 612, 1606,
+    592, 1594, 616, 1648, 590, 1588, 648, 1620, 634, 480, 612, 1602,
+    656, 518, 608, 450, 614, 452, 642, 478, 602, 518, 628, 520,
+    632, 1606, 594, 452, 638, 514, 658, 526, 656, 476, 632, 494,
+    644, 488, 624, 1596, 662, 452, 632, 1634, 618, 1644, 642, 1584,
+    620, 1592, 626, 1638, 644, 1570, 590,
+};
+
+// Mode 7 with a valid checksum
+static const uint16_t CAPTURE_UNKNOWN_MODE[263] = {
+    8054, 3916, 1694, 454, 610, 1540, 642, 1530, 630, 1580, 590, 1556,
+    624, 1582, 628, 1530, 610, 1544, 1724, 472, 1658, 448, 1716, 448,
+    614, 1536, 1666, 482, 1698, 454, 630, 1540, 600, 1508, 632, 1550,
+    644, 1554, 608, 1510, 594, 1534, 1678, 462, 1690, 478, 590, 1580,
+    582, 1536, 600, 1576, 626, 1560, 600, 1578, 632, 1576, 606, 1508,
+    626, 1518, 610, 1560, 608, 1558, 582, 1552, 610, 1510, 610, 1550,
+    590, 1510, 626, 1514, 602, 1552, 648, 1518, 644, 1540, 624, 1512,
+    636, 1546, 590, 1510, 630, 1580, 1678, 488, 1668, 462, 610, 1540,
+    580, 1574, 646, 1576, 628, 1568, 612, 1558, 596, 1528, 590, 1534,
+    580, 1526, 612, 1576, 654, 1526, 1716, 514, 576, 1572, 610, 1524,
+    602, 1528, 1708, 470, 596, 1528, 648, 1544, 604, 1556, 1664, 30962,
+    8078, 3926, 1728, 474, 602, 1516, 654, 1534, 624, 1532, 642, 1550,
+    634, 1516, 628, 1552, 596, 1538, 1686, 500, 1728, 486, 1706, 474,
+    634, 1526, 1678, 492, 1726, 480, 594, 1566, 654, 1552, 582, 1536,
+    640, 1514, 642, 1530, 652, 1586, 1722, 444, 1706, 474, 584, 1578,
+    636, 1576, 626, 1508, 576, 1570, 618, 1532, 632, 1552, 576, 1568,
+    644, 1584, 624, 1524, 576, 1558, 640, 1588, 618, 1576, 648, 1588,
+    620, 1564, 652, 1572, 632, 1580, 574, 1554, 590, 1576, 604, 1530,
+    620, 1508, 652, 1560, 604, 1520, 1704, 446, 1670, 486, 638, 1556,
+    576, 1516, 594, 1510, 618, 1518, 580, 1540, 626, 1570, 582, 1584,
+    604, 1524, 654, 1554, 588, 1582, 1676, 490, 614, 1570, 602, 1570,
+    594, 1508, 1710, 448, 594, 1542, 600, 1544, 592, 1544, 1712,
+};
+
+struct TadiranCapture {
+    const char* name;
+    decode_type_t protocol;   // What IRrecv reports for the frame
+    const uint16_t* raw;      // IRrecvDumpV2 rawData, us
+    uint16_t count;
+    bool tadiran;             // IRTadiran::decode() accepts it
+    bool accepted;            // ... and IRReceiver::decodeCapture() too, as a Tadiran state
+    int mode, temp, fan;      // Expected ReceivedState when it does
+    bool swing;
+};
+
+static const TadiranCapture TADIRAN_CAPTURES[] = {
+    {"off", UNKNOWN, CAPTURE_OFF, 263, true, true, 0, 24, 1, false},
+    {"cool_24_fan2", UNKNOWN, CAPTURE_COOL_24_FAN2, 263, true, true, 1, 24, 2, false},
+    {"heat_24_fan2", UNKNOWN, CAPTURE_HEAT_24_FAN2, 263, true, true, 2, 24, 2, false},
+    {"circulate_24_fan2", UNKNOWN, CAPTURE_CIRCULATE_24_FAN2, 263, true, true, 3, 24, 2, false},
+    {"dry_24_fan2", UNKNOWN, CAPTURE_DRY_24_FAN2, 263, true, true, 4, 24, 2, false},
+    {"cool_24_fan1", UNKNOWN, CAPTURE_COOL_24_FAN1, 263, true, true, 1, 24, 1, false},
+    {"cool_24_fan3", UNKNOWN, CAPTURE_COOL_24_FAN3, 263, true, true, 1, 24, 3, false},
+    {"cool_24_fan4", UNKNOWN, CAPTURE_COOL_24_FAN4, 263, true, true, 1, 24, 4, false},
+    {"cool_16_swing", UNKNOWN, CAPTURE_COOL_16_SWING, 263, true, true, 1, 16, 1, true},
+    {"heat_30_fan4", UNKNOWN, CAPTURE_HEAT_30_FAN4, 263, true, true, 2, 30, 4, false},
+    {"bad_checksum", UNKNOWN, CAPTURE_BAD_CHECKSUM, 263, false, false, 0, 0, 0, false},
+    {"truncated", UNKNOWN, CAPTURE_TRUNCATED, 90, false, false, 0, 0, 0, false},
+    {"nec_tv", NEC, CAPTURE_NEC_TV, 67, false, false, 0, 0, 0, false},
+    {"coolix_cool_24", COOLIX, CAPTURE_COOLIX_COOL_24, 199, false, false, 0, 0, 0, false},
+    {"unknown_mode", UNKNOWN, CAPTURE_UNKNOWN_MODE, 263, true, false, 0, 0, 0, false},
+};
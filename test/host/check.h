@@ -0,0 +1,32 @@
+// Tiny assertion helpers shared by the host tests
+#pragma once
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);      \
+            checkFailures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                           \
+    do {                                                                         \
+        long long _a = (long long)(a), _b = (long long)(b);                      \
+        if (_a != _b) {                                                          \
+            printf("%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n", __FILE__, \
+                   __LINE__, #a, #b, _a, _b);                                    \
+            checkFailures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+static int checkResult(const char* name) {
+    if (checkFailures == 0) {
+        printf("%s: OK\n", name);
+        return 0;
+    }
+    printf("%s: %d failure(s)\n", name, checkFailures);
+    return 1;
+}
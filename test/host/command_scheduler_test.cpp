@@ -0,0 +1,218 @@
+// CommandScheduler admission, priority and shedding
+#include <string.h>
+#include "check.h"
+#include "command_scheduler.h"
+
+static QueuedCommand command(uint32_t client, int mode, int temp = 24) {
+    QueuedCommand c;
+    memset(&c, 0, sizeof(c));
+    c.client = client;
+    c.priority = mode == AC_MODE_OFF ? PRIORITY_SAFETY : PRIORITY_NORMAL;
+    c.model = -1;
+    c.mode = mode;
+    c.temp = temp;
+    c.fan = AC_FAN_MIN;
+    return c;
+}
+
+static void drain(CommandScheduler& scheduler, uint32_t now) {
+    QueuedCommand c;
+    while (scheduler.next(c, now)) {}
+}
+
+static void testRateLimit() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    const uint32_t client = 0x0a01a8c0;
+
+    // A burst, then one command per second
+    for (int i = 0; i < ADMISSION_BURST; i++) {
+        QueuedCommand c = command(client, AC_MODE_COOL);
+        CHECK_EQ(scheduler.submit(c, 1000, retry), ADMIT_OK);
+        drain(scheduler, 1000);
+    }
+    QueuedCommand c = command(client, AC_MODE_COOL);
+    CHECK_EQ(scheduler.submit(c, 1000, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(retry, 1);
+    CHECK_EQ(scheduler.rejectedRate(), 1);
+
+    // Power off draws on its own bucket; internal sources are never limited
+    c = command(client, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(c, 1000, retry), ADMIT_OK);
+    c = command(0, AC_MODE_COOL);
+    CHECK_EQ(scheduler.submit(c, 1000, retry), ADMIT_OK);
+    drain(scheduler, 1000);
+
+    // admit() spends the same tokens without queueing anything
+    CHECK_EQ(scheduler.admit(client, PRIORITY_NORMAL, 2000, retry), ADMIT_OK);
+    CHECK_EQ(scheduler.admit(client, PRIORITY_NORMAL, 2000, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(scheduler.admit(client, PRIORITY_SAFETY, 2000, retry), ADMIT_OK);
+    CHECK_EQ(scheduler.depth(), 0);
+    c = command(client, AC_MODE_COOL);
+    CHECK_EQ(scheduler.submit(c, 2500, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(scheduler.submit(c, 3000, retry), ADMIT_OK);
+
+    // Other clients have their own bucket
+    c = command(client + 1, AC_MODE_COOL);
+    CHECK_EQ(scheduler.submit(c, 3000, retry), ADMIT_OK);
+}
+
+static void testPriorityAndShedding() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    uint32_t ids[ADMISSION_QUEUE_SIZE];
+
+    for (int i = 0; i < ADMISSION_QUEUE_SIZE; i++) {
+        QueuedCommand c = command(0, AC_MODE_COOL, 18 + i);
+        CHECK_EQ(scheduler.submit(c, 100, retry), ADMIT_OK);
+        ids[i] = c.id;
+    }
+    QueuedCommand shed;
+    CHECK(!scheduler.takeShed(shed));
+
+    // Full: normal commands are told when to come back
+    QueuedCommand c = command(0, AC_MODE_HEAT);
+    CHECK_EQ(scheduler.submit(c, 100, retry), ADMIT_QUEUE_FULL);
+    CHECK(retry >= 1);
+    CHECK_EQ(scheduler.rejectedFull(), 1);
+
+    // Power off displaces the newest normal command, which is reported once
+    QueuedCommand off = command(0, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(off, 200, retry), ADMIT_OK);
+    CHECK(scheduler.takeShed(shed));
+    CHECK_EQ(shed.id, ids[ADMISSION_QUEUE_SIZE - 1]);
+    CHECK_EQ(shed.temp, 18 + ADMISSION_QUEUE_SIZE - 1);
+    CHECK(!scheduler.takeShed(shed));
+    CHECK_EQ(scheduler.shed(), 1);
+
+    // A queue of power-offs cannot be displaced
+    QueuedCommand next;
+    CHECK(scheduler.next(next, 300));
+    CHECK_EQ(next.id, off.id);
+    for (int i = 0; i < ADMISSION_QUEUE_SIZE - 1; i++) {
+        CHECK(scheduler.next(next, 400));
+        CHECK_EQ(next.id, ids[i]);
+    }
+    CHECK(!scheduler.next(next, 400));
+    for (int i = 0; i < ADMISSION_QUEUE_SIZE; i++) {
+        QueuedCommand o = command(0, AC_MODE_OFF);
+        CHECK_EQ(scheduler.submit(o, 500, retry), ADMIT_OK);
+    }
+    off = command(0, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(off, 500, retry), ADMIT_QUEUE_FULL);
+    CHECK(!scheduler.takeShed(shed));
+
+    CHECK_EQ(scheduler.maxDepth(), ADMISSION_QUEUE_SIZE);
+    CHECK_EQ(scheduler.maxWaitMs(), 300);
+}
+
+// A client looping power-off is limited too, but keeps its shed rights
+static void testSafetyBucket() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    const uint32_t looper = 0x0b01a8c0;
+    const uint32_t other = 0x0c01a8c0;
+
+    // Fill the queue with another client's commands
+    for (int i = 0; i < ADMISSION_QUEUE_SIZE; i++) {
+        QueuedCommand c = command(i < ADMISSION_BURST ? other : 0, AC_MODE_COOL, 18 + i);
+        CHECK_EQ(scheduler.submit(c, 0, retry), ADMIT_OK);
+    }
+
+    // Each power-off sheds one of them, until the safety bucket is empty
+    for (int i = 0; i < ADMISSION_SAFETY_BURST; i++) {
+        QueuedCommand off = command(looper, AC_MODE_OFF);
+        CHECK_EQ(scheduler.submit(off, 0, retry), ADMIT_OK);
+    }
+    CHECK_EQ(scheduler.shed(), ADMISSION_SAFETY_BURST);
+    QueuedCommand off = command(looper, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(off, 0, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(retry, 1);
+    CHECK_EQ(scheduler.shed(), ADMISSION_SAFETY_BURST);
+
+    // The normal bucket is separate: untouched by power-offs
+    CHECK_EQ(scheduler.admit(looper, PRIORITY_NORMAL, 0, retry), ADMIT_OK);
+
+    // Then one power-off per second
+    CHECK_EQ(scheduler.submit(off, 999, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(scheduler.submit(off, 1000, retry), ADMIT_OK);
+    off = command(looper, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(off, 1000, retry), ADMIT_RATE_LIMITED);
+    CHECK_EQ(scheduler.shed(), ADMISSION_SAFETY_BURST + 1);
+}
+
+// takeIfNext() only dispatches the command that is due
+static void testTakeIfNext() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    QueuedCommand out;
+    CHECK(!scheduler.takeIfNext(1, out, 0));
+
+    QueuedCommand first = command(0, AC_MODE_COOL);
+    QueuedCommand second = command(0, AC_MODE_HEAT);
+    CHECK_EQ(scheduler.submit(first, 0, retry), ADMIT_OK);
+    CHECK_EQ(scheduler.submit(second, 0, retry), ADMIT_OK);
+    CHECK(!scheduler.takeIfNext(second.id, out, 10));
+    CHECK_EQ(scheduler.depth(), 2);
+
+    // A power-off is due before both
+    QueuedCommand off = command(0, AC_MODE_OFF);
+    CHECK_EQ(scheduler.submit(off, 20, retry), ADMIT_OK);
+    CHECK(!scheduler.takeIfNext(first.id, out, 20));
+    CHECK(scheduler.takeIfNext(off.id, out, 20));
+    CHECK_EQ(out.id, off.id);
+    CHECK(scheduler.takeIfNext(first.id, out, 30));
+    CHECK(scheduler.takeIfNext(second.id, out, 40));
+    CHECK_EQ(scheduler.depth(), 0);
+    CHECK_EQ(scheduler.maxWaitMs(), 40);
+}
+
+static void testValuesKeptUntilValidation() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    QueuedCommand c = command(0, 260, 281);
+    c.model = 300;
+    c.fan = -1;
+    CHECK_EQ(scheduler.submit(c, 0, retry), ADMIT_OK);
+    QueuedCommand out;
+    CHECK(scheduler.next(out, 0));
+    CHECK_EQ(out.model, 300);
+    CHECK_EQ(out.mode, 260);
+    CHECK_EQ(out.temp, 281);
+    CHECK_EQ(out.fan, -1);
+}
+
+static void testCancelBySource() {
+    CommandScheduler scheduler;
+    uint32_t retry = 0;
+    const uint8_t SCENE = 3;
+    uint32_t sceneIds[2];
+    for (int i = 0; i < 4; i++) {
+        QueuedCommand c = command(0, AC_MODE_COOL, 20 + i);
+        c.source = i % 2 == 0 ? SCENE : 0;
+        CHECK_EQ(scheduler.submit(c, 0, retry), ADMIT_OK);
+        if (i % 2 == 0) sceneIds[i / 2] = c.id;
+    }
+
+    // Oldest first, only the requested source
+    QueuedCommand dropped;
+    CHECK(scheduler.cancel(SCENE, dropped));
+    CHECK_EQ(dropped.id, sceneIds[0]);
+    CHECK(scheduler.cancel(SCENE, dropped));
+    CHECK_EQ(dropped.id, sceneIds[1]);
+    CHECK(!scheduler.cancel(SCENE, dropped));
+    CHECK_EQ(scheduler.depth(), 2);
+
+    QueuedCommand next;
+    while (scheduler.next(next, 0)) CHECK_EQ(next.source, 0);
+}
+
+int main() {
+    testRateLimit();
+    testPriorityAndShedding();
+    testSafetyBucket();
+    testTakeIfNext();
+    testValuesKeptUntilValidation();
+    testCancelBySource();
+    return checkResult("command_scheduler");
+}
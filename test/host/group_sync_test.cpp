@@ -0,0 +1,133 @@
+// GroupSync fan-out between several instances on the in-process UDP bus
+#include <Arduino.h>
+#include "check.h"
+#include "group_sync.h"
+
+struct Device {
+    GroupSync sync;
+    bool admit = true;
+    int calls = 0;
+    int model = 0, mode = 0, temp = 0, fan = 0;
+    bool swing = false;
+};
+
+static const int DEVICE_COUNT = 4;
+static Device devices[DEVICE_COUNT];
+static Device* active = nullptr;     // Device whose callback is running
+
+static bool onCommand(int model, int mode, int temp, int fan, bool swing) {
+    active->calls++;
+    active->model = model;
+    active->mode = mode;
+    active->temp = temp;
+    active->fan = fan;
+    active->swing = swing;
+    return active->admit;
+}
+
+// The origin blocks in sendCommand(); peers run their loop() meanwhile
+static void servicePeers() {
+    Device* origin = active;
+    for (Device& device : devices) {
+        if (&device == origin) continue;
+        active = &device;
+        device.sync.handle();
+    }
+    active = origin;
+}
+
+static bool send(Device& origin, const char* group, int model, int mode, int temp, int fan, bool swing,
+                 GroupResult& result) {
+    active = &origin;
+    return origin.sync.sendCommand(group, model, mode, temp, fan, swing, result);
+}
+
+static void resetCalls() {
+    for (Device& device : devices) device.calls = 0;
+}
+
+int main() {
+    // 24:0A:C4:12:34:56 onwards - same OUI, only the last byte differs.
+    // The efuse value holds the first address byte in its low bits.
+    for (int i = 0; i < DEVICE_COUNT; i++) {
+        ESP.efuseMac = 0x563412c40a24ULL + ((uint64_t)i << 40);
+        stubLocalIP = IPAddress(192, 168, 1, 20 + i);
+        devices[i].sync.begin(onCommand);
+    }
+    stubDelayHook = servicePeers;
+
+    // IDs come from the NIC-specific bytes, so neighbours do not collide
+    for (int i = 0; i < DEVICE_COUNT; i++) {
+        for (int j = i + 1; j < DEVICE_COUNT; j++) {
+            CHECK(devices[i].sync.deviceId() != devices[j].sync.deviceId());
+        }
+    }
+
+    // Names end up in a comma-separated list
+    CHECK(devices[1].sync.join("floor2"));
+    CHECK(devices[2].sync.join("floor2"));
+    CHECK(devices[3].sync.join("Living Room"));
+    CHECK(!devices[3].sync.join(""));
+    CHECK(!devices[3].sync.join("a,b"));
+    CHECK(!devices[3].sync.join("bad\nname"));
+    CHECK(!devices[3].sync.join("\x7f"));
+    CHECK(!devices[3].sync.join("sixteen-chars-xx"));
+    char list[GROUP_MAX_MEMBERSHIPS * (GROUP_NAME_MAX + 1)];
+    devices[3].sync.membershipList(list, sizeof(list));
+    CHECK(strcmp(list, "Living Room") == 0);
+
+    // Fan-out: members execute once despite the repeats, non-members not at all
+    GroupResult result;
+    CHECK(send(devices[0], "floor2", -1, 1, 24, 2, true, result));
+    CHECK(!result.localMember);
+    CHECK_EQ(devices[0].calls, 0);
+    CHECK_EQ(devices[1].calls, 1);
+    CHECK_EQ(devices[2].calls, 1);
+    CHECK_EQ(devices[3].calls, 0);
+    CHECK_EQ(devices[1].model, -1);
+    CHECK_EQ(devices[1].temp, 24);
+    CHECK(devices[2].swing);
+    CHECK_EQ(result.ackCount, 2);
+    for (int i = 0; i < result.ackCount; i++) {
+        CHECK(result.acks[i].success);
+        CHECK(result.acks[i].deviceId == devices[1].sync.deviceId() ||
+              result.acks[i].deviceId == devices[2].sync.deviceId());
+        CHECK((uint32_t)result.acks[i].ip == (uint32_t)IPAddress(192, 168, 1, 21) ||
+              (uint32_t)result.acks[i].ip == (uint32_t)IPAddress(192, 168, 1, 22));
+    }
+
+    // A member origin runs the command itself; a refusing peer reports it
+    resetCalls();
+    devices[2].admit = false;
+    CHECK(send(devices[1], "floor2", 3, 0, 0, 1, false, result));
+    CHECK(result.localMember);
+    CHECK(result.localSuccess);
+    CHECK_EQ(devices[1].calls, 1);
+    CHECK_EQ(devices[2].calls, 1);
+    CHECK_EQ(result.ackCount, 1);
+    CHECK(!result.acks[0].success);
+    devices[2].admit = true;
+
+    // Out-of-range values reach the peers intact for validation
+    resetCalls();
+    CHECK(send(devices[0], "floor2", 300, 260, 281, 1000, false, result));
+    CHECK_EQ(devices[1].model, 300);
+    CHECK_EQ(devices[1].mode, 260);
+    CHECK_EQ(devices[1].temp, 281);
+    CHECK_EQ(devices[1].fan, 1000);
+    CHECK(send(devices[0], "floor2", -1, -70000, 70000, 0, false, result));
+    CHECK_EQ(devices[2].mode, INT16_MIN);
+    CHECK_EQ(devices[2].temp, INT16_MAX);
+
+    // Leaving stops delivery; bad names are refused up front
+    resetCalls();
+    CHECK(devices[2].sync.leave("floor2"));
+    CHECK(send(devices[0], "floor2", -1, 0, 0, 1, false, result));
+    CHECK_EQ(devices[1].calls, 1);
+    CHECK_EQ(devices[2].calls, 0);
+    CHECK_EQ(result.ackCount, 1);
+    CHECK(!send(devices[0], "a,b", -1, 0, 0, 1, false, result));
+    CHECK(!send(devices[0], "", -1, 0, 0, 1, false, result));
+
+    return checkResult("group_sync");
+}
@@ -0,0 +1,110 @@
+// Tadiran and foreign captures through IRTadiran::decode() and
+// IRReceiver::decodeCapture()
+#include <IRac.h>
+#include <string.h>
+#include "check.h"
+#include "IRTadiran.h"
+#include "ir_receiver.h"
+#include "captures/tadiran_captures.h"
+
+StubAcDecoder stubAcDecoder;
+
+static uint16_t scratch[IR_RECEIVE_BUFFER_SIZE];
+
+// Rebuild what IRrecv hands over: a leading gap, then durations in ticks
+static bool decodeCapture(const TadiranCapture& capture, ReceivedState& state) {
+    static uint16_t rawbuf[IR_RECEIVE_BUFFER_SIZE + 1];
+    rawbuf[0] = 50000 / kRawTick;
+    for (uint16_t i = 0; i < capture.count; i++) rawbuf[i + 1] = capture.raw[i] / kRawTick;
+
+    decode_results results;
+    results.decode_type = capture.protocol;
+    results.rawbuf = rawbuf;
+    results.rawlen = capture.count + 1;
+    memset(&state, 0, sizeof(state));
+    return IRReceiver::decodeCapture(results, scratch, state);
+}
+
+static void testTadiranCaptures() {
+    stubAcDecoder.valid = false;
+    for (const TadiranCapture& capture : TADIRAN_CAPTURES) {
+        bool power, swing;
+        int mode, fan, temp;
+        bool decoded = IRTadiran::decode(capture.raw, capture.count, power, mode, fan, temp, swing);
+        if (decoded != capture.tadiran) printf("  capture %s\n", capture.name);
+        CHECK(decoded == capture.tadiran);
+
+        ReceivedState state;
+        decoded = decodeCapture(capture, state);
+        if (decoded != capture.accepted) printf("  capture %s\n", capture.name);
+        CHECK(decoded == capture.accepted);
+        if (!capture.accepted || !decoded) continue;
+
+        CHECK_EQ(state.protocol, UNKNOWN);
+        CHECK_EQ(state.mode, capture.mode);
+        CHECK_EQ(state.temp, capture.temp);
+        CHECK_EQ(state.fan, capture.fan);
+        CHECK(state.swing == capture.swing);
+        CHECK(power == (capture.mode != AC_MODE_OFF));
+    }
+}
+
+static const TadiranCapture& capture(const char* name) {
+    for (const TadiranCapture& c : TADIRAN_CAPTURES) {
+        if (strcmp(c.name, name) == 0) return c;
+    }
+    printf("no capture %s\n", name);
+    return TADIRAN_CAPTURES[0];
+}
+
+// Other protocols are left to IRac's decoder; check the mapping onto our fields
+static void testForeignCaptures() {
+    ReceivedState state;
+
+    // Decoded by IRrecv, but not an A/C
+    stubAcDecoder.valid = false;
+    CHECK(!decodeCapture(capture("nec_tv"), state));
+
+    stubAcDecoder.valid = true;
+    stubAcDecoder.state = stdAc::state_t();
+    stubAcDecoder.state.power = true;
+    stubAcDecoder.state.mode = stdAc::opmode_t::kCool;
+    stubAcDecoder.state.degrees = 24;
+    stubAcDecoder.state.fanspeed = stdAc::fanspeed_t::kMedium;
+    CHECK(decodeCapture(capture("coolix_cool_24"), state));
+    CHECK_EQ(state.protocol, COOLIX);
+    CHECK_EQ(state.mode, AC_MODE_COOL);
+    CHECK_EQ(state.temp, 24);
+    CHECK_EQ(state.fan, 2);
+    CHECK(!state.swing);
+
+    // Fahrenheit remotes, auto fan, swing
+    stubAcDecoder.state.mode = stdAc::opmode_t::kDry;
+    stubAcDecoder.state.celsius = false;
+    stubAcDecoder.state.degrees = 75;
+    stubAcDecoder.state.fanspeed = stdAc::fanspeed_t::kAuto;
+    stubAcDecoder.state.swingv = stdAc::swingv_t::kAuto;
+    CHECK(decodeCapture(capture("coolix_cool_24"), state));
+    CHECK_EQ(state.mode, AC_MODE_DRY);
+    CHECK_EQ(state.temp, 24);
+    CHECK_EQ(state.fan, -1);
+    CHECK(state.swing);
+
+    // Off whatever the mode says; auto mode has no equivalent here
+    stubAcDecoder.state.power = false;
+    stubAcDecoder.state.mode = stdAc::opmode_t::kAuto;
+    CHECK(decodeCapture(capture("coolix_cool_24"), state));
+    CHECK_EQ(state.mode, AC_MODE_OFF);
+    stubAcDecoder.state.power = true;
+    CHECK(!decodeCapture(capture("coolix_cool_24"), state));
+
+    // UNKNOWN frames that are not Tadiran never reach IRac
+    CHECK(!decodeCapture(capture("bad_checksum"), state));
+    stubAcDecoder.valid = false;
+}
+
+int main() {
+    testTadiranCaptures();
+    testForeignCaptures();
+    return checkResult("ir_receiver");
+}
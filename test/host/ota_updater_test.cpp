@@ -0,0 +1,338 @@
+// OtaUpdater against a local file server: every image format, servers with
+// and without Range, dropped and stalled connections, and bad images
+#include <string.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <Update.h>
+#include "check.h"
+#include "ota_updater.h"
+
+#define URL "http://updates.local/fw"
+
+typedef std::vector<uint8_t> Bytes;
+
+// An app image: the ESP magic, then compressible text mixed with noise,
+// large enough to wrap the 32 KB inflate dictionary twice
+static Bytes makeImage() {
+    Bytes image;
+    image.push_back(0xE9);
+    uint32_t state = 7;
+    const char* text = "ACWebRemote firmware section; ";
+    while (image.size() < 80000) {
+        state = state * 1103515245 + 12345;
+        size_t run = (state >> 16) % 64;
+        if (state & 0x80000000u) {
+            for (size_t i = 0; i < run; i++) image.push_back(text[(image.size() + i) % strlen(text)]);
+        } else {
+            for (size_t i = 0; i < run; i++) {
+                state = state * 1103515245 + 12345;
+                image.push_back((uint8_t)(state >> 24));
+            }
+        }
+    }
+    return image;
+}
+
+static void sha256(const Bytes& data, uint8_t digest[32]) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, data.data(), data.size());
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+}
+
+static void putLe(Bytes& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out.push_back((uint8_t)(value >> (i * 8)));
+}
+
+// gzip, optionally with FEXTRA, FNAME, FCOMMENT and FHCRC all present
+static Bytes gzip(const Bytes& image, bool optionalFields) {
+    Bytes out = {0x1f, 0x8b, 8, 0};
+    putLe(out, 0, 4);
+    out.push_back(0);
+    out.push_back(3);
+    if (optionalFields) {
+        out[3] = 0x04 | 0x08 | 0x10 | 0x02;
+        const char extra[] = "AC\x04\0data";
+        putLe(out, sizeof(extra) - 1, 2);
+        out.insert(out.end(), extra, extra + sizeof(extra) - 1);
+        const char name[] = "firmware.bin";
+        out.insert(out.end(), name, name + sizeof(name));
+        const char comment[] = "built for the host test";
+        out.insert(out.end(), comment, comment + sizeof(comment));
+        putLe(out, crc32(0, out.data(), out.size()) & 0xffff, 2);
+    }
+
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    deflateInit2(&z, 9, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    Bytes deflated(deflateBound(&z, image.size()));
+    z.next_in = (Bytef*)image.data();
+    z.avail_in = image.size();
+    z.next_out = deflated.data();
+    z.avail_out = deflated.size();
+    CHECK_EQ(deflate(&z, Z_FINISH), Z_STREAM_END);
+    out.insert(out.end(), deflated.begin(), deflated.begin() + z.total_out);
+    deflateEnd(&z);
+
+    putLe(out, crc32(0, image.data(), image.size()), 4);
+    putLe(out, image.size(), 4);
+    return out;
+}
+
+// Greedy heatshrink encoder: tag 1 + byte for a literal, tag 0 + index +
+// count for a back-reference, most significant bit first
+static Bytes heatshrink(const Bytes& image, int windowBits, int lookaheadBits) {
+    Bytes out;
+    uint32_t bits = 0;
+    int count = 0;
+    auto put = [&](uint32_t value, int width) {
+        for (int i = width - 1; i >= 0; i--) {
+            bits = bits << 1 | ((value >> i) & 1);
+            if (++count == 8) {
+                out.push_back((uint8_t)bits);
+                bits = 0;
+                count = 0;
+            }
+        }
+    };
+
+    size_t window = (size_t)1 << windowBits;
+    size_t longest = (size_t)1 << lookaheadBits;
+    for (size_t pos = 0; pos < image.size();) {
+        size_t best = 0, bestDistance = 0;
+        for (size_t distance = 1; distance <= window && distance <= pos; distance++) {
+            size_t len = 0;
+            while (len < longest && pos + len < image.size() && image[pos + len] == image[pos - distance + len]) len++;
+            if (len > best) {
+                best = len;
+                bestDistance = distance;
+            }
+        }
+        if (best >= 2 && best * 9 > (size_t)(1 + windowBits + lookaheadBits)) {
+            put(0, 1);
+            put(bestDistance - 1, windowBits);
+            put(best - 1, lookaheadBits);
+            pos += best;
+        } else {
+            put(1, 1);
+            put(image[pos], 8);
+            pos++;
+        }
+    }
+    if (count > 0) put(0, 8 - count);
+    return out;
+}
+
+static void serve(const Bytes& body) {
+    stubHttpServer = StubHttpServer();
+    stubHttpServer.body = body;
+}
+
+// Drive the updater from a simulated loop(), resuming whenever it pauses,
+// until it finishes or fails
+static OtaState run(OtaUpdater& updater, OtaFormat format, uint8_t windowBits, const uint8_t sha[32],
+                    int maxResumes = 100) {
+    CHECK(updater.start(URL, sha, format, windowBits, 4, false));
+    for (int i = 0; i < 200000; i++) {
+        if (updater.state() == OTA_PAUSED) {
+            if (maxResumes-- == 0) break;
+            CHECK(updater.start(URL, sha, format, windowBits, 4, false));
+        }
+        if (updater.state() != OTA_DOWNLOADING) break;
+        stubAdvance(OTA_PASS_BUDGET_MS);
+        updater.handle();
+    }
+    return updater.state();
+}
+
+struct Encoded {
+    const char* name;
+    OtaFormat format;
+    uint8_t windowBits;
+    Bytes body;
+};
+
+static void testFormatsAndServers(const Bytes& image) {
+    uint8_t sha[32];
+    sha256(image, sha);
+    std::vector<Encoded> images = {
+        {"raw", OTA_FORMAT_AUTO, 0, image},
+        {"gzip", OTA_FORMAT_AUTO, 0, gzip(image, false)},
+        {"gzip with header fields", OTA_FORMAT_GZIP, 0, gzip(image, true)},
+        {"heatshrink w8", OTA_FORMAT_HEATSHRINK, 8, heatshrink(image, 8, 4)},
+        {"heatshrink w11", OTA_FORMAT_HEATSHRINK, 11, heatshrink(image, 11, 4)},
+    };
+
+    for (const Encoded& encoded : images) {
+        for (bool range : {true, false}) {
+            for (size_t cut : {0, 777, 5000}) {
+                serve(encoded.body);
+                stubHttpServer.range = range;
+                stubHttpServer.cutAfter = cut;
+                OtaUpdater updater;
+                OtaState state = run(updater, encoded.format, encoded.windowBits, sha);
+                if (state != OTA_DONE || Update.written != image) {
+                    printf("  %s, range %d, cut %zu: %s '%s'\n", encoded.name, range, cut,
+                           OtaUpdater::stateName(state), updater.error());
+                }
+                CHECK_EQ(state, OTA_DONE);
+                CHECK(Update.ended);
+                CHECK(Update.written == image);
+                CHECK_EQ(updater.written(), image.size());
+                CHECK_EQ(updater.received(), encoded.body.size());
+
+                size_t connects = cut == 0 ? 1 : (encoded.body.size() + cut - 1) / cut;
+                CHECK_EQ((size_t)stubHttpServer.connects, connects);
+                CHECK_EQ(updater.resumes(), connects - 1);
+                // Each reconnect asks for the first byte not yet consumed
+                for (size_t i = 0; i < stubHttpServer.ranges.size(); i++) {
+                    if (stubHttpServer.ranges[i] != i * cut) {
+                        CHECK_EQ(stubHttpServer.ranges[i], i * cut);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A connection that goes silent is dropped after the stall timeout and resumed
+static void testStall(const Bytes& image) {
+    uint8_t sha[32];
+    sha256(image, sha);
+    serve(gzip(image, false));
+    stubHttpServer.stallAfter = 3000;
+    OtaUpdater updater;
+    CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha), OTA_DONE);
+    CHECK_EQ(updater.resumes(), 1);
+    CHECK_EQ(stubHttpServer.ranges.size(), 2);
+    CHECK_EQ(stubHttpServer.ranges[1], 3000);
+    CHECK(Update.written == image);
+}
+
+// An unreachable server pauses the update; the same request resumes it
+static void testPauseAndResume(const Bytes& image) {
+    uint8_t sha[32];
+    sha256(image, sha);
+    serve(heatshrink(image, 11, 4));
+    stubHttpServer.cutAfter = 10000;
+    OtaUpdater updater;
+    CHECK(updater.start(URL, sha, OTA_FORMAT_HEATSHRINK, 11, 4, false));
+    for (int i = 0; i < 10000 && stubHttpServer.connects < 2; i++) {
+        stubAdvance(OTA_PASS_BUDGET_MS);
+        updater.handle();
+    }
+    stubHttpServer.status = -1;
+    for (int i = 0; i < 10000 && updater.state() == OTA_DOWNLOADING; i++) {
+        stubAdvance(OTA_PASS_BUDGET_MS);
+        updater.handle();
+    }
+    CHECK_EQ(updater.state(), OTA_PAUSED);
+    CHECK_EQ(updater.received(), 20000);
+
+    stubHttpServer.status = HTTP_CODE_OK;
+    stubHttpServer.cutAfter = 0;
+    CHECK_EQ(run(updater, OTA_FORMAT_HEATSHRINK, 11, sha), OTA_DONE);
+    CHECK_EQ(stubHttpServer.ranges.back(), 20000);
+    CHECK(Update.written == image);
+}
+
+static void testBadImages(const Bytes& image) {
+    uint8_t sha[32];
+    sha256(image, sha);
+
+    // Right image, wrong hash: never marked bootable
+    {
+        uint8_t wrong[32];
+        memcpy(wrong, sha, sizeof(wrong));
+        wrong[31] ^= 1;
+        serve(gzip(image, true));
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, wrong), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "SHA-256 mismatch") == 0);
+        CHECK(!Update.ended);
+        CHECK(!Update.isRunning());
+    }
+    // A flipped bit in heatshrink data decodes to the wrong bytes
+    {
+        Bytes body = heatshrink(image, 11, 4);
+        body[body.size() / 2] ^= 0x10;
+        serve(body);
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_HEATSHRINK, 11, sha), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "SHA-256 mismatch") == 0);
+        CHECK(!Update.ended);
+    }
+    // gzip that ends before the deflate stream does
+    {
+        Bytes body = gzip(image, false);
+        body.resize(body.size() / 2);
+        serve(body);
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "Truncated gzip stream") == 0);
+        CHECK(!Update.ended);
+    }
+    // Invalid block type right at the start of the deflate stream
+    {
+        Bytes body = gzip(image, false);
+        body[10] = 0x07;
+        serve(body);
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "Corrupt deflate data") == 0);
+    }
+    // The file is replaced between two connections
+    {
+        Bytes body = gzip(image, false);
+        serve(body);
+        stubHttpServer.cutAfter = 5000;
+        OtaUpdater updater;
+        CHECK(updater.start(URL, sha, OTA_FORMAT_AUTO, 0, 4, false));
+        for (int i = 0; i < 10000 && updater.received() < 5000; i++) {
+            stubAdvance(OTA_PASS_BUDGET_MS);
+            updater.handle();
+        }
+        stubHttpServer.body.push_back(0);
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha, 0), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "Image changed on the server") == 0);
+    }
+    // Not found, and not an image AUTO recognises
+    {
+        serve(image);
+        stubHttpServer.status = 404;
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha), OTA_FAILED);
+        CHECK(strcmp(updater.error(), "HTTP 404") == 0);
+    }
+    {
+        serve(Bytes(1000, 0x42));
+        OtaUpdater updater;
+        CHECK_EQ(run(updater, OTA_FORMAT_AUTO, 0, sha), OTA_FAILED);
+        CHECK(strncmp(updater.error(), "Unrecognised image", 18) == 0);
+    }
+}
+
+// The digest stub itself, so a mismatch above means the updater
+static void testSha256() {
+    uint8_t digest[32];
+    sha256(Bytes{'a', 'b', 'c'}, digest);
+    const uint8_t expected[4] = {0xba, 0x78, 0x16, 0xbf};
+    CHECK(memcmp(digest, expected, sizeof(expected)) == 0);
+    sha256(Bytes(1000, 'a'), digest);
+    const uint8_t thousand[4] = {0x41, 0xed, 0xec, 0xe4};
+    CHECK(memcmp(digest, thousand, sizeof(thousand)) == 0);
+}
+
+int main() {
+    Bytes image = makeImage();
+    testSha256();
+    testFormatsAndServers(image);
+    testStall(image);
+    testPauseAndResume(image);
+    testBadImages(image);
+    return checkResult("ota_updater");
+}
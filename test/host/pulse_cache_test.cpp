@@ -0,0 +1,129 @@
+// PulseCache capture, confirmation by a second render, and replay
+#include <string.h>
+#include "check.h"
+#include "pulse_cache.h"
+
+#define CARRIER_US 26
+
+static uint32_t clockUs = 1000;
+
+// Drive one mark as 38 kHz carrier edges, then stay dark for `space`
+static void mark(PulseCache& cache, uint32_t duration, uint32_t space) {
+    uint32_t end = clockUs + duration;
+    while (clockUs < end) {
+        cache.recordEdge(true, clockUs);
+        cache.recordEdge(false, clockUs + CARRIER_US / 2);
+        clockUs += CARRIER_US;
+    }
+    clockUs += space;
+}
+
+// A header plus `bits` data bits of the given value. `splitBit` puts a
+// 150 us gap into that bit's mark, like a transmit held up by an interrupt.
+static void render(PulseCache& cache, uint32_t key, uint32_t value, int bits = 24, int splitBit = -1) {
+    cache.beginCapture(true);
+    mark(cache, 3000, 1500);
+    for (int i = 0; i < bits; i++) {
+        if (i == splitBit) {
+            mark(cache, 260, 150);
+            mark(cache, 260, (value >> i) & 1 ? 1500 : 500);
+        } else {
+            mark(cache, 520, (value >> i) & 1 ? 1500 : 500);
+        }
+    }
+    mark(cache, 520, 0);
+    cache.endCapture(key);
+}
+
+static void testSecondRenderConfirms() {
+    PulseCache cache;
+    IRsend irsend(0);
+
+    render(cache, 1, 0xa5a5a5);
+    CHECK(!cache.contains(1));
+    CHECK_EQ(cache.entries(), 0);
+    CHECK(!cache.replay(1, &irsend));
+
+    render(cache, 1, 0xa5a5a5);
+    CHECK(cache.contains(1));
+    CHECK(cache.takeDirty());
+    CHECK(cache.replay(1, &irsend));
+    CHECK_EQ(irsend.lastCount, 2 * 26 - 1);
+    CHECK_EQ(irsend.lastKhz, 38);
+    CHECK_EQ(cache.unstable(), 0);
+}
+
+static void testDisturbedRenderIsDropped() {
+    PulseCache cache;
+    IRsend irsend(0);
+
+    // Clean, then split: they disagree, the split one becomes the candidate
+    render(cache, 1, 0x123456);
+    render(cache, 1, 0x123456, 24, 7);
+    CHECK(!cache.contains(1));
+    CHECK_EQ(cache.unstable(), 1);
+
+    // A clean render does not confirm the split one either
+    render(cache, 1, 0x123456);
+    CHECK(!cache.contains(1));
+    CHECK_EQ(cache.unstable(), 2);
+
+    render(cache, 1, 0x123456);
+    CHECK(cache.contains(1));
+    CHECK(cache.replay(1, &irsend));
+    CHECK_EQ(irsend.lastCount, 2 * 26 - 1);
+    for (uint16_t i = 0; i < irsend.lastCount; i++) {
+        // No mark shorter than a data bit's
+        if (i % 2 == 0) CHECK(irsend.lastRaw[i] >= 450);
+    }
+}
+
+// States sent alternately (e.g. a thermostat starting and stopping) each keep their candidate
+static void testInterleavedStates() {
+    PulseCache cache;
+    for (uint32_t key = 1; key <= PULSE_CACHE_PENDING; key++) {
+        render(cache, key, key * 0x010101);
+    }
+    CHECK_EQ(cache.entries(), 0);
+    for (uint32_t key = 1; key <= PULSE_CACHE_PENDING; key++) {
+        render(cache, key, key * 0x010101);
+        CHECK(cache.contains(key));
+    }
+    CHECK_EQ(cache.unstable(), 0);
+
+    // Beyond the candidate slots, the oldest candidate is replaced
+    for (uint32_t key = 10; key <= 10 + PULSE_CACHE_PENDING; key++) {
+        render(cache, key, key);
+    }
+    render(cache, 11, 11);
+    CHECK(cache.contains(11));
+    render(cache, 10, 10);
+    CHECK(!cache.contains(10));
+}
+
+// A capture that does not fit is counted and leaves the cache alone
+static void testUncacheable() {
+    PulseCache cache;
+    render(cache, 1, 0xffffff);
+    render(cache, 1, 0xffffff);
+    CHECK(cache.contains(1));
+
+    cache.beginCapture(true);
+    uint32_t duration = 300;
+    for (int i = 0; i < 20; i++) {
+        mark(cache, duration, 400);
+        duration = duration * 5 / 4;
+    }
+    cache.endCapture(2);
+    CHECK_EQ(cache.uncacheable(), 1);
+    CHECK(cache.contains(1));
+    CHECK_EQ(cache.entries(), 1);
+}
+
+int main() {
+    testSecondRenderConfirms();
+    testDisturbedRenderIsDropped();
+    testInterleavedStates();
+    testUncacheable();
+    return checkResult("pulse_cache");
+}
@@ -0,0 +1,94 @@
+// StateHistory bucket aggregation, including ranges at the edge of uint32
+#include <string.h>
+#include "check.h"
+#include "state_history.h"
+
+static uint32_t totalRuntime(const HistoryBucket* buckets, size_t count, int mode) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < count; i++) total += buckets[i].runtime[mode];
+    return total;
+}
+
+static void testBucketCount() {
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 3600), 24);
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 7000), 13);
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 86400), 1);
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 0), 0);
+    CHECK_EQ(StateHistory::bucketCount(100, 100, 1), 0);
+    CHECK_EQ(StateHistory::bucketCount(200, 100, 1), 0);
+
+    // Wider than the range: used to be one bucket that the walk ran past
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 86401), 0);
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, 4000000000u), 0);
+    CHECK_EQ(StateHistory::bucketCount(0, 86400, UINT32_MAX), 0);
+
+    // (to - from) + bucket - 1 no longer wraps
+    CHECK_EQ(StateHistory::bucketCount(0, UINT32_MAX, 0x80000000u), 2);
+    CHECK_EQ(StateHistory::bucketCount(0, UINT32_MAX, UINT32_MAX), 1);
+    CHECK_EQ(StateHistory::bucketCount(0, UINT32_MAX, UINT32_MAX - 1), 2);
+    CHECK_EQ(StateHistory::bucketCount(UINT32_MAX - 100, UINT32_MAX, 30), 4);
+}
+
+// Each case gets one spare bucket that must stay untouched
+static void testEdgeRanges() {
+    StateHistory history;
+    uint32_t t = StateHistory::now();
+    history.append(HISTORY_SOURCE_HTTP, 0, AC_MODE_COOL, 24, AC_FAN_MIN, false, true);
+
+    HistoryBucket buckets[HISTORY_MAX_BUCKETS + 1];
+    HistoryBucket guard;
+    memset(&guard, 0xa5, sizeof(guard));
+
+    // A huge bucket is refused instead of looping
+    CHECK_EQ(history.aggregate(t - 86400, t + 86400, 4000000000u, t + 10, buckets, HISTORY_MAX_BUCKETS), 0);
+
+    // Last seconds before the end of uint32 time
+    memcpy(&buckets[4], &guard, sizeof(guard));
+    size_t count = history.aggregate(UINT32_MAX - 100, UINT32_MAX, 30, UINT32_MAX, buckets, HISTORY_MAX_BUCKETS);
+    CHECK_EQ(count, 4);
+    CHECK_EQ(buckets[0].runtime[AC_MODE_COOL], 30);
+    CHECK_EQ(buckets[3].runtime[AC_MODE_COOL], 10);
+    CHECK_EQ(totalRuntime(buckets, count, AC_MODE_COOL), 100);
+    CHECK_EQ(buckets[3].start, UINT32_MAX - 10);
+    CHECK(memcmp(&buckets[4], &guard, sizeof(guard)) == 0);
+
+    // The end of the last bucket lies beyond UINT32_MAX
+    memcpy(&buckets[2], &guard, sizeof(guard));
+    count = history.aggregate(0, UINT32_MAX, UINT32_MAX - 1, UINT32_MAX, buckets, HISTORY_MAX_BUCKETS);
+    CHECK_EQ(count, 2);
+    CHECK_EQ(buckets[0].runtime[AC_MODE_COOL], UINT32_MAX - 1 - t);
+    CHECK_EQ(buckets[1].runtime[AC_MODE_COOL], 1);
+    CHECK_EQ(buckets[0].commands, 1);
+    CHECK(memcmp(&buckets[2], &guard, sizeof(guard)) == 0);
+
+    // Whole range in two halves
+    memcpy(&buckets[2], &guard, sizeof(guard));
+    count = history.aggregate(0, UINT32_MAX, 0x80000000u, t + 1000, buckets, HISTORY_MAX_BUCKETS);
+    CHECK_EQ(count, 2);
+    CHECK_EQ(totalRuntime(buckets, count, AC_MODE_COOL), 1000);
+    CHECK(memcmp(&buckets[2], &guard, sizeof(guard)) == 0);
+}
+
+// An ordinary day of hourly buckets still adds up
+static void testHourlyBuckets() {
+    StateHistory history;
+    uint32_t t = StateHistory::now();
+    history.append(HISTORY_SOURCE_API, 0, AC_MODE_HEAT, 26, AC_FAN_MIN, false, true);
+    history.append(HISTORY_SOURCE_API, 0, AC_MODE_HEAT, 27, AC_FAN_MIN, false, false);
+
+    HistoryBucket buckets[HISTORY_MAX_BUCKETS];
+    uint32_t from = t - t % 3600;
+    size_t count = history.aggregate(from, from + 86400, 3600, t + 5400, buckets, HISTORY_MAX_BUCKETS);
+    CHECK_EQ(count, 24);
+    CHECK_EQ(totalRuntime(buckets, count, AC_MODE_HEAT), 5400);
+    CHECK_EQ(buckets[0].commands, 2);
+    CHECK_EQ(buckets[0].suppressed, 1);
+    CHECK_EQ(buckets[0].setpointSeconds, 26 * buckets[0].onSeconds);
+}
+
+int main() {
+    testBucketCount();
+    testEdgeRanges();
+    testHourlyBuckets();
+    return checkResult("state_history");
+}
@@ -0,0 +1,54 @@
+// Minimal Arduino surface for host tests: a manual clock and a quiet Serial
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s) {}
+    String(int value) : _s(std::to_string(value)) {}
+    const char* c_str() const { return _s.c_str(); }
+    size_t length() const { return _s.size(); }
+    void reserve(size_t n) { _s.reserve(n); }
+    int toInt() const { return atoi(_s.c_str()); }
+    bool operator==(const char* other) const { return _s == other; }
+private:
+    std::string _s;
+};
+
+struct SerialStub {
+    void printf(const char*, ...) {}
+    void print(const char*) {}
+    void println(const char* = "") {}
+    void println(const String&) {}
+};
+extern SerialStub Serial;
+
+struct EspStub {
+    uint64_t efuseMac = 0;
+    uint64_t getEfuseMac() { return efuseMac; }
+    uint32_t getFreeHeap() { return 0; }
+    void restart() {}
+};
+extern EspStub ESP;
+
+// Time only moves through delay() or stubAdvance(); delay() also runs
+// stubDelayHook so tests can service other simulated devices meanwhile
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+void stubAdvance(unsigned long ms);
+extern void (*stubDelayHook)();
+uint32_t esp_random();
+
+// GPIO: the core's implementation behind the weak digitalWrite(), which
+// pulse_cache.cpp overrides
+#define LOW 0x0
+#define HIGH 0x1
+extern "C" void __digitalWrite(uint8_t pin, uint8_t val);
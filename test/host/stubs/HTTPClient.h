@@ -0,0 +1,74 @@
+#pragma once
+#include <stdio.h>
+#include <vector>
+#include <WiFiClient.h>
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_PARTIAL_CONTENT 206
+
+// A file server for one image, with the failures OtaUpdater has to survive
+struct StubHttpServer {
+    std::vector<uint8_t> body;
+    int status = 200;           // Anything but 200 is answered as is (negative = connect error)
+    bool range = true;          // Honour Range with 206; otherwise send the whole body again
+    size_t cutAfter = 0;        // Close each connection this many bytes past the requested offset
+    size_t stallAfter = 0;      // Go silent after this many bytes, on the next connection only
+    int connects = 0;
+    std::vector<size_t> ranges; // Offset asked for by each request
+};
+extern StubHttpServer stubHttpServer;
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient& client, const char* url) {
+        _client = &client;
+        _from = 0;
+        return strncmp(url, "http://", 7) == 0;
+    }
+    void end() {
+        if (_client != nullptr) _client->open = false;
+    }
+    void useHTTP10(bool) {}
+    void setReuse(bool) {}
+    void setConnectTimeout(int32_t) {}
+    void setTimeout(uint16_t) {}
+    void collectHeaders(const char**, size_t) {}
+    void addHeader(const char* name, const char* value) {
+        if (strcmp(name, "Range") == 0) sscanf(value, "bytes=%zu-", &_from);
+    }
+
+    int GET() {
+        StubHttpServer& server = stubHttpServer;
+        server.connects++;
+        server.ranges.push_back(_from);
+        if (server.status != HTTP_CODE_OK) return server.status;
+
+        size_t size = server.body.size();
+        size_t first = server.range ? _from : 0;
+        size_t last = size;
+        if (server.cutAfter > 0 && _from + server.cutAfter < last) last = _from + server.cutAfter;
+        _client->hangs = false;
+        if (server.stallAfter > 0) {
+            if (first + server.stallAfter < last) last = first + server.stallAfter;
+            _client->hangs = true;
+            server.stallAfter = 0;
+        }
+        _client->data = server.body.data() + first;
+        _client->len = last > first ? last - first : 0;
+        _client->pos = 0;
+        _client->open = true;
+
+        _size = size - first;
+        snprintf(_contentRange, sizeof(_contentRange), "bytes %zu-%zu/%zu", first, size - 1, size);
+        return server.range && _from > 0 ? HTTP_CODE_PARTIAL_CONTENT : HTTP_CODE_OK;
+    }
+    int getSize() { return _size; }
+    String header(const char*) { return String(_contentRange); }
+    static String errorToString(int) { return String("connection refused"); }
+
+private:
+    WiFiClient* _client = nullptr;
+    size_t _from = 0;
+    int _size = 0;
+    char _contentRange[64] = "";
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include "Arduino.h"
+
+// Stored in network byte order like the ESP32 core
+class IPAddress {
+public:
+    IPAddress() : _addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        uint8_t bytes[4] = {a, b, c, d};
+        memcpy(&_addr, bytes, 4);
+    }
+    IPAddress(uint32_t addr) : _addr(addr) {}
+    operator uint32_t() const { return _addr; }
+    uint8_t operator[](int i) const { return reinterpret_cast<const uint8_t*>(&_addr)[i]; }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(buf);
+    }
+private:
+    uint32_t _addr;
+};
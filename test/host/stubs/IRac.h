@@ -0,0 +1,38 @@
+// stdAc state plus a decodeToState() that returns what the test set up,
+// standing in for IRremoteESP8266's per-protocol decoders
+#pragma once
+#include "IRrecv.h"
+
+namespace stdAc {
+enum class opmode_t { kOff = -1, kAuto = 0, kCool = 1, kHeat = 2, kDry = 3, kFan = 4 };
+enum class fanspeed_t { kAuto = 0, kMin = 1, kLow = 2, kMedium = 3, kHigh = 4, kMax = 5 };
+enum class swingv_t { kOff = -1, kAuto = 0, kHighest = 1, kHigh = 2, kMiddle = 3, kLow = 4, kLowest = 5 };
+
+struct state_t {
+    decode_type_t protocol = UNKNOWN;
+    bool power = false;
+    opmode_t mode = opmode_t::kOff;
+    float degrees = 0;
+    bool celsius = true;
+    fanspeed_t fanspeed = fanspeed_t::kAuto;
+    swingv_t swingv = swingv_t::kOff;
+};
+}  // namespace stdAc
+
+// Decoded state for captures whose decode_type is not UNKNOWN; `valid`
+// false makes decodeToState() fail (a protocol that is not an A/C)
+struct StubAcDecoder {
+    bool valid = false;
+    stdAc::state_t state;
+};
+extern StubAcDecoder stubAcDecoder;
+
+namespace IRAcUtils {
+inline bool decodeToState(const decode_results* decode, stdAc::state_t* result,
+                          const stdAc::state_t* = nullptr) {
+    if (!stubAcDecoder.valid) return false;
+    *result = stubAcDecoder.state;
+    result->protocol = decode->decode_type;
+    return true;
+}
+}  // namespace IRAcUtils
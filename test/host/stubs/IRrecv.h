@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+#include "IRremoteESP8266.h"
+
+struct decode_results {
+    decode_type_t decode_type = UNKNOWN;
+    volatile uint16_t* rawbuf = nullptr;   // rawbuf[0] is the gap before the frame
+    uint16_t rawlen = 0;
+    bool overflow = false;
+};
+
+class IRrecv {
+public:
+    IRrecv(uint16_t, uint16_t, uint8_t, bool) {}
+    void enableIRIn() {}
+    void disableIRIn() {}
+    bool decode(decode_results*) { return false; }
+};
@@ -0,0 +1,14 @@
+// Just the IRremoteESP8266 types the firmware's decode path uses
+#pragma once
+#include <stdint.h>
+
+enum decode_type_t {
+    UNKNOWN = -1,
+    UNUSED = 0,
+    NEC = 3,
+    COOLIX = 15,
+    DAIKIN = 16,
+    MITSUBISHI_AC = 20,
+};
+
+const uint16_t kRawTick = 2;   // Microseconds per rawbuf unit
@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+
+class IRsend {
+public:
+    explicit IRsend(uint16_t) {}
+    void begin() {}
+    void sendRaw(const uint16_t* raw, uint16_t count, uint16_t khz) {
+        lastRaw = raw;
+        lastCount = count;
+        lastKhz = khz;
+    }
+
+    // What the last sendRaw() replayed
+    const uint16_t* lastRaw = nullptr;
+    uint16_t lastCount = 0;
+    uint16_t lastKhz = 0;
+};
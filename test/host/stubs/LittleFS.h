@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// No flash on the host: begin() fails, so nothing is read or written
+class File {
+public:
+    explicit operator bool() const { return false; }
+    size_t read(uint8_t*, size_t) { return 0; }
+    size_t write(const uint8_t*, size_t) { return 0; }
+    void close() {}
+};
+
+struct LittleFSStub {
+    bool begin(bool = false) { return false; }
+    File open(const char*, const char*) { return File(); }
+};
+extern LittleFSStub LittleFS;
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+// The inactive app partition: collects what would be flashed
+class UpdateClass {
+public:
+    bool begin(size_t) {
+        written.clear();
+        running = true;
+        ended = false;
+        return true;
+    }
+    size_t write(uint8_t* data, size_t len) {
+        written.insert(written.end(), data, data + len);
+        return len;
+    }
+    bool end(bool) {
+        running = false;
+        ended = true;
+        return true;
+    }
+    void abort() { running = false; }
+    bool isRunning() { return running; }
+    const char* errorString() { return "Flash error"; }
+
+    std::vector<uint8_t> written;
+    bool running = false;
+    bool ended = false;     // Marked bootable
+};
+extern UpdateClass Update;
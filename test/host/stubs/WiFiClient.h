@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+
+// One response body, fed by HTTPClient::GET()
+class WiFiClient {
+public:
+    int available() { return open ? (int)(len - pos) : 0; }
+    bool connected() { return open && (pos < len || hangs); }
+    int read(uint8_t* buffer, size_t size) {
+        if (size > len - pos) size = len - pos;
+        memcpy(buffer, data + pos, size);
+        pos += size;
+        return size;
+    }
+
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    size_t pos = 0;
+    bool open = false;
+    bool hangs = false;     // Stays connected, silent, after the last byte
+};
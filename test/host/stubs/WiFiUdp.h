@@ -0,0 +1,45 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include "IPAddress.h"
+
+// In-process UDP: every socket bound to a port hears multicast sent to it,
+// unicast goes to the socket whose local address matches. Sockets take
+// their address from stubLocalIP when they are bound.
+class WiFiUDP {
+public:
+    WiFiUDP();
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port);
+    uint8_t beginMulticast(IPAddress group, uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(const uint8_t* data, size_t len);
+    int endPacket();
+
+    int parsePacket();
+    int read(uint8_t* data, size_t len);
+    int read(char* data, size_t len) { return read(reinterpret_cast<uint8_t*>(data), len); }
+    IPAddress remoteIP() { return _current.from; }
+    uint16_t remotePort() { return _current.port; }
+
+private:
+    struct Datagram {
+        IPAddress from;
+        uint16_t port;
+        std::vector<uint8_t> data;
+    };
+    IPAddress _local;
+    uint16_t _port;
+    bool _bound;
+    IPAddress _to;
+    uint16_t _toPort;
+    std::vector<uint8_t> _out;
+    std::deque<Datagram> _inbox;
+    Datagram _current;
+    size_t _readPos;
+};
+
+extern IPAddress stubLocalIP;
@@ -0,0 +1,53 @@
+#pragma once
+// The ROM inflater's interface, decoded by zlib's raw inflate on the host.
+// zlib keeps its own window, so the caller's wrapping dictionary is only
+// written to, exactly where tinfl would write.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4
+};
+
+typedef enum {
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+struct tinfl_decompressor_tag {
+    z_stream stream;
+    bool started;
+};
+typedef struct tinfl_decompressor_tag tinfl_decompressor;
+
+// Like the ROM macro, reinitialises without freeing: the stub leaks one
+// zlib state per decoder, which is fine for a test process
+#define tinfl_init(r) ((r)->started = false)
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize,
+                                     uint8_t*, uint8_t* out, size_t* outSize, uint32_t) {
+    if (!r->started) {
+        memset(&r->stream, 0, sizeof(r->stream));
+        if (inflateInit2(&r->stream, -15) != Z_OK) return TINFL_STATUS_FAILED;
+        r->started = true;
+    }
+    r->stream.next_in = (Bytef*)in;
+    r->stream.avail_in = (uInt)*inSize;
+    r->stream.next_out = out;
+    r->stream.avail_out = (uInt)*outSize;
+    int result = inflate(&r->stream, Z_NO_FLUSH);
+    *inSize -= r->stream.avail_in;
+    *outSize -= r->stream.avail_out;
+
+    if (result == Z_STREAM_END) return TINFL_STATUS_DONE;
+    if (result != Z_OK && result != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+    return r->stream.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+
+typedef void* QueueHandle_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+#define pdPASS 1
+#define pdTRUE 1
+#define pdMS_TO_TICKS(ms) (ms)
@@ -0,0 +1,8 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, unsigned, void*, unsigned, TaskHandle_t*, int) {
+    return 0;
+}
+inline void vTaskDelay(unsigned) {}
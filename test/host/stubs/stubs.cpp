@@ -0,0 +1,110 @@
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <LittleFS.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <algorithm>
+
+SerialStub Serial;
+EspStub ESP;
+LittleFSStub LittleFS;
+UpdateClass Update;
+StubHttpServer stubHttpServer;
+
+static unsigned long nowMs = 0;
+void (*stubDelayHook)() = nullptr;
+
+unsigned long millis() { return nowMs; }
+unsigned long micros() { return nowMs * 1000; }
+void stubAdvance(unsigned long ms) { nowMs += ms; }
+void yield() {}
+
+void delay(unsigned long ms) {
+    nowMs += ms;
+    if (stubDelayHook) stubDelayHook();
+}
+
+extern "C" void __digitalWrite(uint8_t, uint8_t) {}
+
+uint32_t esp_random() {
+    static uint32_t state = 0x12345678;
+    state = state * 1664525 + 1013904223;
+    return state;
+}
+
+// ===== UDP =====
+
+IPAddress stubLocalIP(192, 168, 1, 10);
+
+// Function-local so sockets in other translation units' globals can register
+static std::vector<WiFiUDP*>& sockets() {
+    static std::vector<WiFiUDP*> list;
+    return list;
+}
+
+WiFiUDP::WiFiUDP() : _port(0), _bound(false), _toPort(0), _readPos(0) {
+    _current.port = 0;
+    sockets().push_back(this);
+}
+
+WiFiUDP::~WiFiUDP() {
+    std::vector<WiFiUDP*>& list = sockets();
+    list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    _local = stubLocalIP;
+    _port = port;
+    _bound = true;
+    return 1;
+}
+
+uint8_t WiFiUDP::beginMulticast(IPAddress, uint16_t port) {
+    return begin(port);
+}
+
+void WiFiUDP::stop() {
+    _bound = false;
+    _inbox.clear();
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    _to = ip;
+    _toPort = port;
+    _out.clear();
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t len) {
+    _out.insert(_out.end(), data, data + len);
+    return len;
+}
+
+int WiFiUDP::endPacket() {
+    bool multicast = _to[0] >= 224 && _to[0] <= 239;
+    for (WiFiUDP* socket : sockets()) {
+        if (!socket->_bound || socket->_port != _toPort) continue;
+        if (!multicast && (uint32_t)socket->_local != (uint32_t)_to) continue;
+        Datagram datagram;
+        datagram.from = _local;
+        datagram.port = _port;
+        datagram.data = _out;
+        socket->_inbox.push_back(datagram);
+    }
+    return 1;
+}
+
+int WiFiUDP::parsePacket() {
+    if (_inbox.empty()) return 0;
+    _current = _inbox.front();
+    _inbox.pop_front();
+    _readPos = 0;
+    return (int)_current.data.size();
+}
+
+int WiFiUDP::read(uint8_t* data, size_t len) {
+    size_t n = std::min(len, _current.data.size() - _readPos);
+    memcpy(data, _current.data.data() + _readPos, n);
+    _readPos += n;
+    return (int)n;
+}
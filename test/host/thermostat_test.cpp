@@ -0,0 +1,178 @@
+// Thermostat control loop against a simple room model
+#include <math.h>
+#include "check.h"
+#include "thermostat.h"
+
+// Deterministic sensor noise, so a failure reproduces
+static uint32_t noiseState = 3;
+static double noise() {
+    noiseState = noiseState * 1103515245 + 12345;
+    return (int)((noiseState >> 16) % 100 - 50) / 50000.0;
+}
+
+static ThermostatSettings cooling() {
+    ThermostatSettings settings = Thermostat::defaults();
+    settings.mode = THERMOSTAT_COOL;
+    settings.target = 240;
+    return settings;
+}
+
+// Six hours of a room drifting towards 31 C outside, cooled by the unit
+// while it runs. Readings arrive every 30 s and the same settings are
+// pushed again every 10 minutes, as a home automation system would.
+static void testRoomModel() {
+    Thermostat thermostat;
+    ThermostatSettings settings = cooling();
+    ThermostatCommand unit = {AC_MODE_OFF, 24, AC_FAN_MIN, false};
+    thermostat.configure(settings, unit);
+
+    double room = 27.0;
+    const double outside = 31.0;
+    uint32_t now = 1000;
+    uint32_t lastChange = 0;    // Boot counts as a change
+    bool running = false;
+    uint32_t transitions = 0;
+    double low = 99, high = 0;
+
+    for (int step = 0; step < 6 * 3600; step++) {
+        now += 1000;
+        room += (outside - room) / 3600.0 - (running ? 0.004 : 0) + noise();
+        if (step % 30 == 0) thermostat.reportTemperature((int16_t)lround(room * 10), now);
+        if (step % 600 == 0) thermostat.configure(settings, unit);
+
+        ThermostatCommand command;
+        if (thermostat.update(now, command)) {
+            bool run = command.mode != AC_MODE_OFF;
+            // Only starts and stops, never a repeat of the current state
+            CHECK(run != running);
+            uint32_t minimum = running ? settings.minOnMs : settings.minOffMs;
+            CHECK(now - lastChange >= minimum);
+            thermostat.markIssued(command, now);
+            unit = command;
+            running = run;
+            lastChange = now;
+            transitions++;
+        }
+        if (step > 3600) {
+            low = fmin(low, room);
+            high = fmax(high, room);
+        }
+    }
+
+    CHECK(transitions > 4);
+    CHECK_EQ(thermostat.commands(), transitions);
+    CHECK_EQ(thermostat.cycles(), (transitions + 1) / 2);
+    CHECK_EQ(thermostat.readings(), 6 * 3600 / 30);
+    // The band plus what the minimum times let the room drift
+    CHECK(low > 22.5 && high < 25.5);
+}
+
+// A reading across the band right after a start waits out the minimum run
+static void testMinimumTimesHold() {
+    Thermostat thermostat;
+    ThermostatSettings settings = cooling();
+    thermostat.configure(settings, {AC_MODE_OFF, 24, AC_FAN_MIN, false});
+    uint32_t start = settings.minOffMs;
+    uint32_t now = start;
+    ThermostatCommand command;
+
+    thermostat.reportTemperature(260, now);
+    CHECK(thermostat.update(now, command));
+    thermostat.markIssued(command, now);
+
+    now += 60000;
+    thermostat.reportTemperature(220, now);
+    CHECK(!thermostat.update(now, command));
+    CHECK(!thermostat.update(now + 1000, command));
+    CHECK_EQ(thermostat.held(), 1);
+    CHECK_EQ(thermostat.holdRemainingMs(now), settings.minOnMs - 60000);
+
+    now = start + settings.minOnMs;
+    thermostat.reportTemperature(220, now);
+    CHECK(thermostat.update(now, command));
+    CHECK_EQ(command.mode, AC_MODE_OFF);
+    thermostat.markIssued(command, now);
+    CHECK_EQ(thermostat.holdRemainingMs(now), 0);
+}
+
+// After a reset the unit may have just stopped or started, so the first
+// decision still waits out the minimum time, counted from boot
+static void testMinimumTimesFromBoot() {
+    ThermostatSettings settings = cooling();
+    ThermostatCommand command;
+    {
+        Thermostat thermostat;
+        thermostat.configure(settings, {AC_MODE_OFF, 24, AC_FAN_MIN, false});
+        thermostat.reportTemperature(300, 1000);
+        CHECK(!thermostat.update(1000, command));
+        CHECK_EQ(thermostat.held(), 1);
+        CHECK_EQ(thermostat.holdRemainingMs(1000), settings.minOffMs - 1000);
+        thermostat.reportTemperature(300, settings.minOffMs);
+        CHECK(thermostat.update(settings.minOffMs, command));
+        CHECK_EQ(command.mode, AC_MODE_COOL);
+    }
+    {
+        Thermostat thermostat;
+        thermostat.configure(settings, {AC_MODE_COOL, 24, AC_FAN_MIN, false});
+        thermostat.reportTemperature(220, 1000);
+        CHECK(!thermostat.update(1000, command));
+        CHECK_EQ(thermostat.holdRemainingMs(1000), settings.minOnMs - 1000);
+        thermostat.reportTemperature(220, settings.minOnMs);
+        CHECK(thermostat.update(settings.minOnMs, command));
+        CHECK_EQ(command.mode, AC_MODE_OFF);
+    }
+}
+
+// Without a recent reading the unit is stopped
+static void testStaleReadingStops() {
+    Thermostat thermostat;
+    thermostat.configure(cooling(), {AC_MODE_OFF, 24, AC_FAN_MIN, false});
+    uint32_t now = THERMOSTAT_DEFAULT_MIN_OFF_MS;
+    ThermostatCommand command;
+
+    thermostat.reportTemperature(300, now);
+    CHECK(thermostat.update(now, command));
+    CHECK_EQ(command.mode, AC_MODE_COOL);
+    thermostat.markIssued(command, now);
+    CHECK(thermostat.running());
+
+    now += THERMOSTAT_STALE_MS;
+    CHECK(!thermostat.hasReading(now));
+    CHECK(thermostat.update(now, command));
+    CHECK_EQ(command.mode, AC_MODE_OFF);
+    thermostat.markIssued(command, now);
+    CHECK(!thermostat.update(now + 1000, command));
+}
+
+// Switching off stops only a unit the thermostat was running; a manual
+// override never sends anything
+static void testOffAndOverride() {
+    Thermostat thermostat;
+    ThermostatSettings settings = cooling();
+    ThermostatCommand command;
+    uint32_t now = 1000;
+
+    thermostat.configure(settings, {AC_MODE_OFF, 24, AC_FAN_MIN, false});
+    thermostat.reportTemperature(230, now);
+    CHECK(!thermostat.update(now, command));
+    settings.mode = THERMOSTAT_OFF;
+    thermostat.configure(settings, {AC_MODE_OFF, 24, AC_FAN_MIN, false});
+    CHECK(!thermostat.update(now, command));
+
+    settings.mode = THERMOSTAT_COOL;
+    thermostat.configure(settings, {AC_MODE_COOL, 24, AC_FAN_MIN, false});
+    thermostat.reportTemperature(300, now);
+    CHECK(!thermostat.update(now, command));
+    thermostat.manualOverride();
+    CHECK(!thermostat.enabled());
+    CHECK(!thermostat.update(now, command));
+}
+
+int main() {
+    testRoomModel();
+    testMinimumTimesHold();
+    testMinimumTimesFromBoot();
+    testStaleReadingStops();
+    testOffAndOverride();
+    return checkResult("thermostat");
+}
@@ -0,0 +1,463 @@
+#include "acfleet.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+
+namespace acfleet {
+
+typedef std::chrono::steady_clock Clock;
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+static std::string addressKey(const Device& device) {
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &device.addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(device.port);
+}
+
+// ===== DEVICES =====
+
+Device parseDevice(const std::string& spec) {
+    Device device;
+    std::string rest = spec;
+    if (rest.compare(0, 7, "http://") == 0) rest = rest.substr(7);
+    size_t slash = rest.find('/');
+    if (slash != std::string::npos) rest = rest.substr(0, slash);
+
+    size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        device.port = (uint16_t)atoi(rest.c_str() + colon + 1);
+        rest = rest.substr(0, colon);
+    }
+    device.host = rest;
+    device.name = spec;
+    return device;
+}
+
+bool resolve(Device& device, std::string& error) {
+    if (device.resolved) return true;
+
+    device.addr.sin_family = AF_INET;
+    device.addr.sin_port = htons(device.port);
+    if (inet_pton(AF_INET, device.host.c_str(), &device.addr.sin_addr) == 1) {
+        device.resolved = true;
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* info = nullptr;
+    int rc = getaddrinfo(device.host.c_str(), nullptr, &hints, &info);
+    if (rc != 0 || info == nullptr) {
+        error = std::string("cannot resolve ") + device.host + ": " + gai_strerror(rc);
+        return false;
+    }
+    device.addr.sin_addr = reinterpret_cast<sockaddr_in*>(info->ai_addr)->sin_addr;
+    freeaddrinfo(info);
+    device.resolved = true;
+    return true;
+}
+
+// ===== HTTP RESPONSE PARSING =====
+
+static std::string lowerCase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return text;
+}
+
+// Returns true once `raw` holds a complete response (or `closed` ends it)
+static bool parseResponse(const std::string& raw, bool closed, Result& result, bool& keepAlive) {
+    size_t headerEnd = raw.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return false;
+
+    std::string headers = lowerCase(raw.substr(0, headerEnd));
+    size_t bodyStart = headerEnd + 4;
+
+    int status = 0;
+    if (sscanf(raw.c_str(), "HTTP/%*d.%*d %d", &status) != 1) return false;
+    keepAlive = headers.find("connection: close") == std::string::npos &&
+                headers.compare(0, 8, "http/1.0") != 0;
+
+    size_t lengthPos = headers.find("content-length:");
+    if (lengthPos != std::string::npos) {
+        size_t length = strtoul(headers.c_str() + lengthPos + 15, nullptr, 10);
+        if (raw.size() - bodyStart < length) return false;
+        result.status = status;
+        result.body = raw.substr(bodyStart, length);
+        return true;
+    }
+
+    if (headers.find("transfer-encoding: chunked") != std::string::npos) {
+        std::string body;
+        size_t pos = bodyStart;
+        while (true) {
+            size_t lineEnd = raw.find("\r\n", pos);
+            if (lineEnd == std::string::npos) return false;
+            size_t size = strtoul(raw.c_str() + pos, nullptr, 16);
+            if (size == 0) {
+                if (raw.find("\r\n", lineEnd + 2) == std::string::npos) return false;
+                break;
+            }
+            if (raw.size() < lineEnd + 2 + size + 2) return false;
+            body.append(raw, lineEnd + 2, size);
+            pos = lineEnd + 2 + size + 2;
+        }
+        result.status = status;
+        result.body = body;
+        return true;
+    }
+
+    // No length: the body runs until the server closes the connection
+    if (!closed) return false;
+    keepAlive = false;
+    result.status = status;
+    result.body = raw.substr(bodyStart);
+    return true;
+}
+
+// ===== FLEET CLIENT =====
+
+namespace {
+
+enum Phase { PHASE_WAITING, PHASE_CONNECTING, PHASE_SENDING, PHASE_READING, PHASE_DONE };
+
+struct Job {
+    Device* device;
+    Result result;
+    Phase phase = PHASE_WAITING;
+    int fd = -1;
+    bool pooled = false;
+    bool keepAlive = false;
+    size_t sent = 0;
+    std::string response;
+    Clock::time_point start;
+    Clock::time_point attemptStart;
+};
+
+}  // namespace
+
+FleetClient::FleetClient(const Options& options) : _options(options) {
+}
+
+FleetClient::~FleetClient() {
+    closeAll();
+}
+
+void FleetClient::closeAll() {
+    for (auto& entry : _pool) close(entry.second);
+    _pool.clear();
+}
+
+int FleetClient::takePooled(const Device& device) {
+    auto it = _pool.find(addressKey(device));
+    if (it == _pool.end()) return -1;
+    int fd = it->second;
+    _pool.erase(it);
+    return fd;
+}
+
+void FleetClient::release(const Device& device, int fd) {
+    std::string key = addressKey(device);
+    auto it = _pool.find(key);
+    if (it != _pool.end()) close(it->second);
+    _pool[key] = fd;
+}
+
+std::vector<Result> FleetClient::get(std::vector<Device>& devices, const std::string& path) {
+    std::vector<Job> jobs(devices.size());
+    std::deque<size_t> waiting;
+    for (size_t i = 0; i < devices.size(); i++) {
+        jobs[i].device = &devices[i];
+        jobs[i].result.device = devices[i].name;
+        waiting.push_back(i);
+    }
+
+    size_t active = 0;
+    size_t remaining = jobs.size();
+
+    auto finish = [&](Job& job, const std::string& error) {
+        if (job.fd >= 0) {
+            if (error.empty() && _options.keepAlive && job.keepAlive) {
+                release(*job.device, job.fd);
+            } else {
+                close(job.fd);
+            }
+            job.fd = -1;
+        }
+        job.result.error = error;
+        job.result.ms = elapsedMs(job.start);
+        job.phase = PHASE_DONE;
+        active--;
+        remaining--;
+    };
+
+    // Start (or restart) an attempt; `fresh` skips the pool after a stale reuse.
+    // Returns an error message if the attempt could not even be started.
+    auto startAttempt = [&](Job& job, bool fresh) -> std::string {
+        job.response.clear();
+        job.sent = 0;
+        job.attemptStart = Clock::now();
+        job.pooled = false;
+
+        std::string error;
+        if (!resolve(*job.device, error)) return error;
+
+        if (!fresh && _options.keepAlive) {
+            job.fd = takePooled(*job.device);
+            if (job.fd >= 0) {
+                job.pooled = true;
+                job.result.reusedConnection = true;
+                job.phase = PHASE_SENDING;
+                return "";
+            }
+        }
+        job.result.reusedConnection = false;
+
+        job.fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (job.fd < 0) return std::string("socket: ") + strerror(errno);
+        fcntl(job.fd, F_SETFL, fcntl(job.fd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(job.fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        int rc = connect(job.fd, reinterpret_cast<sockaddr*>(&job.device->addr), sizeof(job.device->addr));
+        if (rc == 0) {
+            job.phase = PHASE_SENDING;
+        } else if (errno == EINPROGRESS) {
+            job.phase = PHASE_CONNECTING;
+        } else {
+            error = std::string("connect: ") + strerror(errno);
+            close(job.fd);
+            job.fd = -1;
+        }
+        return error;
+    };
+
+    // A failed attempt is retried until the retry budget runs out
+    auto fail = [&](Job& job, std::string error) {
+        if (job.fd >= 0) {
+            close(job.fd);
+            job.fd = -1;
+        }
+        while (job.result.attempts <= _options.retries) {
+            job.result.attempts++;
+            error = startAttempt(job, true);
+            if (error.empty()) return;
+        }
+        finish(job, error);
+    };
+
+    // The device dropped our idle pooled connection; not the device's fault
+    auto restartFresh = [&](Job& job) {
+        close(job.fd);
+        job.fd = -1;
+        std::string error = startAttempt(job, true);
+        if (!error.empty()) fail(job, error);
+    };
+
+    std::string request;
+    while (remaining > 0) {
+        // Admit waiting jobs up to the concurrency limit
+        while (!waiting.empty() && active < _options.maxConcurrency) {
+            Job& job = jobs[waiting.front()];
+            waiting.pop_front();
+            active++;
+            job.start = Clock::now();
+            job.result.attempts = 1;
+            std::string error = startAttempt(job, false);
+            if (!error.empty()) fail(job, error);
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<Job*> owners;
+        int waitMs = _options.timeoutMs;
+        for (Job& job : jobs) {
+            if (job.phase == PHASE_DONE || job.phase == PHASE_WAITING || job.fd < 0) continue;
+            pollfd entry{};
+            entry.fd = job.fd;
+            entry.events = job.phase == PHASE_READING ? POLLIN : POLLOUT;
+            fds.push_back(entry);
+            owners.push_back(&job);
+            int left = _options.timeoutMs - (int)elapsedMs(job.attemptStart);
+            waitMs = std::max(0, std::min(waitMs, left));
+        }
+        if (fds.empty()) continue;
+
+        int ready = poll(fds.data(), fds.size(), waitMs);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            // The event loop cannot go on: every unfinished job fails and
+            // gives its socket back
+            std::string error = std::string("poll: ") + strerror(errno);
+            for (Job& job : jobs) {
+                if (job.phase == PHASE_DONE) continue;
+                if (job.phase == PHASE_WAITING) {
+                    job.start = Clock::now();
+                    active++;
+                }
+                finish(job, error);
+            }
+            break;
+        }
+
+        for (size_t i = 0; i < fds.size(); i++) {
+            Job& job = *owners[i];
+            short revents = fds[i].revents;
+
+            if (revents == 0) {
+                if (elapsedMs(job.attemptStart) >= _options.timeoutMs) fail(job, "timeout");
+                continue;
+            }
+
+            if (job.phase == PHASE_CONNECTING) {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(job.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0) {
+                    fail(job, std::string("connect: ") + strerror(err));
+                    continue;
+                }
+                job.phase = PHASE_SENDING;
+            }
+
+            if (job.phase == PHASE_SENDING) {
+                request = "GET " + path + " HTTP/1.1\r\nHost: " + job.device->host +
+                          "\r\nUser-Agent: acfleet\r\nConnection: " +
+                          (_options.keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+                ssize_t n = send(job.fd, request.data() + job.sent, request.size() - job.sent, SEND_FLAGS);
+                if (n < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
+                    if (job.pooled) {
+                        restartFresh(job);
+                    } else {
+                        fail(job, std::string("send: ") + strerror(errno));
+                    }
+                    continue;
+                }
+                job.sent += n;
+                if (job.sent == request.size()) job.phase = PHASE_READING;
+                continue;
+            }
+
+            if (job.phase == PHASE_READING) {
+                char buffer[4096];
+                ssize_t n = recv(job.fd, buffer, sizeof(buffer), 0);
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+                bool closed = n <= 0;
+                if (n > 0) job.response.append(buffer, n);
+
+                if (parseResponse(job.response, closed, job.result, job.keepAlive)) {
+                    finish(job, "");
+                } else if (closed) {
+                    if (job.pooled && job.response.empty()) {
+                        restartFresh(job);
+                    } else {
+                        fail(job, "connection closed before a full response");
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Result> results;
+    results.reserve(jobs.size());
+    for (Job& job : jobs) results.push_back(job.result);
+    return results;
+}
+
+// ===== OUTPUT =====
+
+static std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string formatResults(const std::vector<Result>& results, double wallMs, bool json) {
+    size_t ok = 0;
+    double slowest = 0;
+    double sum = 0;
+    for (const Result& r : results) {
+        if (r.ok()) ok++;
+        slowest = std::max(slowest, r.ms);
+        sum += r.ms;
+    }
+
+    std::string out;
+    char line[512];
+    if (json) {
+        out = "{\"devices\":[";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            bool bodyIsJson = !r.body.empty() && (r.body[0] == '{' || r.body[0] == '[');
+            snprintf(line, sizeof(line), "%s{\"device\":\"%s\",\"ok\":%s,\"status\":%d,\"ms\":%.1f,\"attempts\":%d,\"reused\":%s,",
+                     i > 0 ? "," : "", jsonEscape(r.device).c_str(), r.ok() ? "true" : "false", r.status, r.ms,
+                     r.attempts, r.reusedConnection ? "true" : "false");
+            out += line;
+            if (!r.error.empty()) {
+                out += "\"error\":\"" + jsonEscape(r.error) + "\"}";
+            } else if (bodyIsJson) {
+                out += "\"body\":" + r.body + "}";
+            } else {
+                out += "\"body\":\"" + jsonEscape(r.body) + "\"}";
+            }
+        }
+        snprintf(line, sizeof(line), "],\"ok\":%zu,\"failed\":%zu,\"wall_ms\":%.1f,\"slowest_ms\":%.1f,\"sum_ms\":%.1f}\n",
+                 ok, results.size() - ok, wallMs, slowest, sum);
+        out += line;
+        return out;
+    }
+
+    snprintf(line, sizeof(line), "%-28s %6s %9s %4s %5s  %s\n", "DEVICE", "STATUS", "MS", "TRY", "REUSE", "RESULT");
+    out += line;
+    for (const Result& r : results) {
+        std::string detail = r.error.empty() ? r.body : r.error;
+        std::replace(detail.begin(), detail.end(), '\n', ' ');
+        if (detail.size() > 60) detail = detail.substr(0, 57) + "...";
+        snprintf(line, sizeof(line), "%-28s %6d %9.1f %4d %5s  %s\n", r.device.c_str(), r.status, r.ms, r.attempts,
+                 r.reusedConnection ? "yes" : "no", detail.c_str());
+        out += line;
+    }
+    snprintf(line, sizeof(line), "%zu ok, %zu failed in %.1f ms (slowest device %.1f ms, sum of devices %.1f ms)\n",
+             ok, results.size() - ok, wallMs, slowest, sum);
+    out += line;
+    return out;
+}
+
+}  // namespace acfleet
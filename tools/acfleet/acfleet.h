@@ -0,0 +1,77 @@
+#ifndef ACFLEET_H
+#define ACFLEET_H
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace acfleet {
+
+// One AC Web Remote controller
+struct Device {
+    std::string name;       // Display name (mDNS instance or host as given)
+    std::string host;       // Host name or dotted IPv4 address
+    uint16_t port = 80;
+    sockaddr_in addr{};     // Filled by resolve()
+    bool resolved = false;
+};
+
+// Outcome of one request against one device
+struct Result {
+    std::string device;
+    int status = 0;         // HTTP status, 0 if no response
+    std::string body;
+    std::string error;      // Empty on success
+    double ms = 0;          // Wall time including retries
+    int attempts = 0;
+    bool reusedConnection = false;
+
+    bool ok() const { return error.empty() && status >= 200 && status < 300; }
+};
+
+struct Options {
+    int timeoutMs = 2000;   // Per attempt
+    int retries = 1;        // Extra attempts after the first
+    size_t maxConcurrency = 64;
+    bool keepAlive = true;
+};
+
+// Resolve host names to IPv4 addresses (blocking, done once per device)
+bool resolve(Device& device, std::string& error);
+
+// Parse "host", "host:port" or "http://host:port" into a device
+Device parseDevice(const std::string& spec);
+
+// Issues the same GET request to many devices at once on a poll()-based
+// event loop. Idle keep-alive connections are pooled per device and reused
+// by later calls; a request on a pooled connection that turns out to be
+// closed is retried on a fresh one without counting against `retries`.
+class FleetClient {
+public:
+    explicit FleetClient(const Options& options = Options());
+    ~FleetClient();
+
+    FleetClient(const FleetClient&) = delete;
+    FleetClient& operator=(const FleetClient&) = delete;
+
+    std::vector<Result> get(std::vector<Device>& devices, const std::string& path);
+
+    size_t pooledConnections() const { return _pool.size(); }
+    void closeAll();
+
+private:
+    Options _options;
+    std::map<std::string, int> _pool;   // "ip:port" -> idle socket
+
+    int takePooled(const Device& device);
+    void release(const Device& device, int fd);
+};
+
+// Summarise a fleet run as a text table (or JSON when `json` is set)
+std::string formatResults(const std::vector<Result>& results, double wallMs, bool json);
+
+}  // namespace acfleet
+
+#endif // ACFLEET_H
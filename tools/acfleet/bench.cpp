@@ -0,0 +1,173 @@
+// acfleet-bench - compare sequential and concurrent fleet sweeps against
+// simulated devices on 127.0.0.1.
+//
+// Each simulated device is a single-threaded HTTP/1.1 server that waits
+// `--latency` ms per request and an extra `--accept` ms on every new
+// connection, standing in for the TCP handshake and lwIP accept cost over
+// Wi-Fi. Like the ESP32 WebServer in the firmware, it answers every request
+// with `Connection: close`; `--keep-alive 1` simulates a server that keeps
+// connections open instead, to measure the client's connection pool.
+//
+//   acfleet-bench [--devices N] [--latency MS] [--accept MS] [--rounds N] [--keep-alive 0|1]
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "acfleet.h"
+
+static std::atomic<bool> stopping(false);
+
+static void serveDevice(int listenFd, int index, int latencyMs, int acceptMs, bool keepAlive) {
+    std::vector<int> clients;
+    std::vector<std::string> buffers;
+    char body[128];
+    int bodyLen = snprintf(body, sizeof(body),
+                           "{\"model\":0,\"mode\":1,\"temp\":24,\"fan\":2,\"swing\":false,\"device\":%d}", index);
+
+    while (!stopping) {
+        std::vector<pollfd> fds;
+        fds.push_back({listenFd, POLLIN, 0});
+        for (int fd : clients) fds.push_back({fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), 50) <= 0) continue;
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(acceptMs));
+                clients.push_back(fd);
+                buffers.emplace_back();
+            }
+        }
+
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            size_t c = i - 1;
+            char buffer[2048];
+            ssize_t n = recv(clients[c], buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                close(clients[c]);
+                clients[c] = -1;
+                continue;
+            }
+            buffers[c].append(buffer, n);
+
+            size_t end;
+            while ((end = buffers[c].find("\r\n\r\n")) != std::string::npos) {
+                bool closeAfter = !keepAlive || buffers[c].find("Connection: close") < end;
+                buffers[c].erase(0, end + 4);
+                std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+
+                char response[512];
+                int len = snprintf(response, sizeof(response),
+                                   "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                                   "Content-Length: %d\r\nConnection: %s\r\n\r\n%s",
+                                   bodyLen, closeAfter ? "close" : "keep-alive", body);
+                send(clients[c], response, len, 0);
+                if (closeAfter) {
+                    close(clients[c]);
+                    clients[c] = -1;
+                    break;
+                }
+            }
+        }
+
+        for (size_t c = clients.size(); c-- > 0;) {
+            if (clients[c] < 0) {
+                clients.erase(clients.begin() + c);
+                buffers.erase(buffers.begin() + c);
+            }
+        }
+    }
+
+    for (int fd : clients) close(fd);
+    close(listenFd);
+}
+
+static double sweep(acfleet::FleetClient& client, std::vector<acfleet::Device>& devices, size_t& failures) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<acfleet::Result> results = client.get(devices, "/api/ac");
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const acfleet::Result& r : results) {
+        if (!r.ok()) failures++;
+    }
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    int deviceCount = 50;
+    int latencyMs = 20;
+    int acceptMs = 10;
+    int rounds = 5;
+    bool keepAlive = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--devices") == 0) deviceCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--latency") == 0) latencyMs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--accept") == 0) acceptMs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--rounds") == 0) rounds = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--keep-alive") == 0) keepAlive = atoi(argv[i + 1]) != 0;
+    }
+
+    std::vector<acfleet::Device> devices;
+    std::vector<std::thread> servers;
+    for (int i = 0; i < deviceCount; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), len) != 0 || listen(fd, 16) != 0) {
+            perror("listen");
+            return 1;
+        }
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+
+        acfleet::Device device;
+        device.name = "sim-" + std::to_string(i);
+        device.host = "127.0.0.1";
+        device.port = ntohs(addr.sin_port);
+        devices.push_back(device);
+        servers.emplace_back(serveDevice, fd, i, latencyMs, acceptMs, keepAlive);
+    }
+
+    printf("%d simulated devices, %d ms per request, %d ms per new connection, %s\n\n",
+           deviceCount, latencyMs, acceptMs, keepAlive ? "keep-alive" : "Connection: close (firmware)");
+
+    size_t failures = 0;
+
+    // Baseline: one device after another on a fresh connection, like a curl loop
+    acfleet::Options sequentialOptions;
+    sequentialOptions.keepAlive = false;
+    sequentialOptions.maxConcurrency = 1;
+    acfleet::FleetClient sequential(sequentialOptions);
+    double sequentialMs = sweep(sequential, devices, failures);
+
+    acfleet::FleetClient concurrent;
+    double coldMs = sweep(concurrent, devices, failures);
+    double warmTotal = 0;
+    for (int r = 0; r < rounds; r++) warmTotal += sweep(concurrent, devices, failures);
+    double warmMs = rounds > 0 ? warmTotal / rounds : 0;
+
+    printf("%-34s %10s %9s\n", "MODE", "WALL MS", "SPEEDUP");
+    printf("%-34s %10.1f %9s\n", "sequential, new connection each", sequentialMs, "1.0x");
+    printf("%-34s %10.1f %8.1fx\n", "concurrent, cold connections", coldMs, sequentialMs / coldMs);
+    printf("%-34s %10.1f %8.1fx\n", keepAlive ? "concurrent, pooled keep-alive" : "concurrent, repeated sweeps",
+           warmMs, sequentialMs / warmMs);
+    printf("\n%zu pooled connection(s), %zu failed request(s)\n", concurrent.pooledConnections(), failures);
+
+    stopping = true;
+    for (std::thread& t : servers) t.join();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// acfleet - query and command many AC Web Remote devices at once
+//
+//   acfleet discover
+//   acfleet status  [--discover | HOST...]
+//   acfleet set mode=1 temp=24 [fan=2 swing=1] [--discover | HOST...]
+//   acfleet off     [--discover | HOST...]
+//   acfleet get PATH [--discover | HOST...]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "acfleet.h"
+#include "mdns.h"
+
+static void usage() {
+    fprintf(stderr,
+            "Usage: acfleet [options] COMMAND [ARGS] [HOST...]\n"
+            "\n"
+            "Commands:\n"
+            "  discover                 List devices found via mDNS\n"
+            "  status                   Current AC state (GET /api/ac)\n"
+            "  set KEY=VALUE...         Send a command (mode, temp, fan, swing, model)\n"
+            "  off                      Turn the AC off\n"
+            "  get PATH                 GET an arbitrary path\n"
+            "\n"
+            "Options:\n"
+            "  --discover               Target all devices found via mDNS\n"
+            "  --discover-ms N          mDNS listen time (default 1500)\n"
+            "  --timeout N              Per-attempt timeout in ms (default 2000)\n"
+            "  --retries N              Retries per device (default 1)\n"
+            "  --concurrency N          Max devices in flight (default 64)\n"
+            "  --json                   JSON output\n");
+}
+
+int main(int argc, char** argv) {
+    acfleet::Options options;
+    bool useDiscovery = false;
+    bool json = false;
+    int discoverMs = 1500;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--discover") {
+            useDiscovery = true;
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--discover-ms" && hasValue) {
+            discoverMs = atoi(argv[++i]);
+        } else if (arg == "--timeout" && hasValue) {
+            options.timeoutMs = atoi(argv[++i]);
+        } else if (arg == "--retries" && hasValue) {
+            options.retries = atoi(argv[++i]);
+        } else if (arg == "--concurrency" && hasValue) {
+            options.maxConcurrency = (size_t)atoi(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            usage();
+            return 2;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
+        usage();
+        return 2;
+    }
+    std::string command = positional[0];
+    positional.erase(positional.begin());
+
+    if (command == "discover") {
+        std::vector<acfleet::Device> found = acfleet::discover(discoverMs);
+        if (json) {
+            printf("[");
+            for (size_t i = 0; i < found.size(); i++) {
+                printf("%s{\"name\":\"%s\",\"host\":\"%s\",\"port\":%u}", i > 0 ? "," : "",
+                       found[i].name.c_str(), found[i].host.c_str(), found[i].port);
+            }
+            printf("]\n");
+        } else {
+            for (const acfleet::Device& d : found) {
+                printf("%-24s %s:%u\n", d.name.c_str(), d.host.c_str(), d.port);
+            }
+            printf("%zu device(s)\n", found.size());
+        }
+        return 0;
+    }
+
+    // Build the request path; remaining positionals are hosts
+    std::string path;
+    if (command == "status") {
+        path = "/api/ac";
+    } else if (command == "off") {
+        path = "/set?mode=0";
+    } else if (command == "get") {
+        if (positional.empty()) {
+            usage();
+            return 2;
+        }
+        path = positional[0];
+        positional.erase(positional.begin());
+    } else if (command == "set") {
+        path = "/set";
+        char separator = '?';
+        while (!positional.empty() && positional[0].find('=') != std::string::npos) {
+            path += separator + positional[0];
+            separator = '&';
+            positional.erase(positional.begin());
+        }
+        if (separator == '?') {
+            fprintf(stderr, "set needs at least one KEY=VALUE\n");
+            return 2;
+        }
+    } else {
+        fprintf(stderr, "Unknown command: %s\n", command.c_str());
+        usage();
+        return 2;
+    }
+
+    std::vector<acfleet::Device> devices;
+    if (useDiscovery) devices = acfleet::discover(discoverMs);
+    for (const std::string& host : positional) devices.push_back(acfleet::parseDevice(host));
+    if (devices.empty()) {
+        fprintf(stderr, "No devices (give hosts or --discover)\n");
+        return 1;
+    }
+
+    acfleet::FleetClient client(options);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<acfleet::Result> results = client.get(devices, path);
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    fputs(acfleet::formatResults(results, wallMs, json).c_str(), stdout);
+    for (const acfleet::Result& r : results) {
+        if (!r.ok()) return 1;
+    }
+    return 0;
+}
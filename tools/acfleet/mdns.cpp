@@ -0,0 +1,205 @@
+#include "mdns.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace acfleet {
+
+#define MDNS_PORT 5353
+#define MDNS_ADDR "224.0.0.251"
+#define MDNS_SERVICE "_acremote._tcp.local"  // Only AC remotes advertise this
+#define MDNS_QUERIES 3                          // Sent across the listen window; one datagram is easily lost
+
+#define DNS_TYPE_A 1
+#define DNS_TYPE_PTR 12
+#define DNS_TYPE_SRV 33
+
+// ===== PACKET ENCODING =====
+
+static void putName(std::vector<uint8_t>& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) dot = name.size();
+        out.push_back((uint8_t)(dot - start));
+        out.insert(out.end(), name.begin() + start, name.begin() + dot);
+        start = dot + 1;
+    }
+    out.push_back(0);
+}
+
+static std::vector<uint8_t> buildQuery() {
+    std::vector<uint8_t> query = {
+        0x00, 0x00,  // ID
+        0x00, 0x00,  // Flags: standard query
+        0x00, 0x01,  // One question
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    putName(query, MDNS_SERVICE);
+    query.insert(query.end(), {0x00, DNS_TYPE_PTR, 0x00, 0x01});
+    return query;
+}
+
+// ===== PACKET DECODING =====
+
+// Reads a possibly compressed name at `pos`; advances `pos` past it
+static bool readName(const uint8_t* data, size_t len, size_t& pos, std::string& name) {
+    name.clear();
+    size_t cursor = pos;
+    bool jumped = false;
+    for (int hops = 0; hops < 32; hops++) {
+        if (cursor >= len) return false;
+        uint8_t label = data[cursor];
+        if (label == 0) {
+            if (!jumped) pos = cursor + 1;
+            return true;
+        }
+        if ((label & 0xC0) == 0xC0) {
+            if (cursor + 1 >= len) return false;
+            if (!jumped) pos = cursor + 2;
+            jumped = true;
+            cursor = ((label & 0x3F) << 8) | data[cursor + 1];
+            continue;
+        }
+        if (cursor + 1 + label > len) return false;
+        if (!name.empty()) name += '.';
+        name.append(reinterpret_cast<const char*>(data + cursor + 1), label);
+        cursor += 1 + label;
+    }
+    return false;
+}
+
+static uint16_t read16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+struct ServiceRecord {
+    std::string target;
+    uint16_t port = 0;
+};
+
+struct Answers {
+    std::vector<std::string> instances;            // PTR targets
+    std::map<std::string, ServiceRecord> services;  // SRV by instance
+    std::map<std::string, in_addr> addresses;      // A by host name
+};
+
+static void parsePacket(const uint8_t* data, size_t len, Answers& answers) {
+    if (len < 12) return;
+    uint16_t questions = read16(data + 4);
+    uint16_t records = read16(data + 6) + read16(data + 8) + read16(data + 10);
+    size_t pos = 12;
+    std::string name;
+
+    for (int i = 0; i < questions; i++) {
+        if (!readName(data, len, pos, name) || pos + 4 > len) return;
+        pos += 4;
+    }
+
+    for (int i = 0; i < records; i++) {
+        if (!readName(data, len, pos, name) || pos + 10 > len) return;
+        uint16_t type = read16(data + pos);
+        uint16_t rdlength = read16(data + pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) return;
+        size_t rdata = pos;
+
+        if (type == DNS_TYPE_PTR && strcasecmp(name.c_str(), MDNS_SERVICE) == 0) {
+            std::string instance;
+            size_t cursor = rdata;
+            if (readName(data, len, cursor, instance)) answers.instances.push_back(instance);
+        } else if (type == DNS_TYPE_SRV && rdlength >= 6) {
+            ServiceRecord record;
+            record.port = read16(data + rdata + 4);
+            size_t cursor = rdata + 6;
+            if (readName(data, len, cursor, record.target)) answers.services[name] = record;
+        } else if (type == DNS_TYPE_A && rdlength == 4) {
+            in_addr addr;
+            memcpy(&addr, data + rdata, 4);
+            answers.addresses[name] = addr;
+        }
+        pos += rdlength;
+    }
+}
+
+// ===== DISCOVERY =====
+
+std::vector<Device> discover(int timeoutMs) {
+    std::vector<Device> devices;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return devices;
+
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(MDNS_PORT);
+    inet_pton(AF_INET, MDNS_ADDR, &dest.sin_addr);
+
+    std::vector<uint8_t> query = buildQuery();
+    int queries = 0;
+
+    Answers answers;
+    std::map<std::string, in_addr> senders;  // Instance -> responding address
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= timeoutMs) break;
+
+        // Query at the start and again at even intervals; answers are merged by instance
+        if (queries < MDNS_QUERIES && elapsed >= queries * timeoutMs / MDNS_QUERIES) {
+            sendto(fd, query.data(), query.size(), 0, reinterpret_cast<sockaddr*>(&dest), sizeof(dest));
+            queries++;
+        }
+        int wait = timeoutMs - elapsed;
+        if (queries < MDNS_QUERIES) wait = std::min(wait, queries * timeoutMs / MDNS_QUERIES - elapsed);
+
+        pollfd entry{fd, POLLIN, 0};
+        if (poll(&entry, 1, std::max(wait, 0)) <= 0) continue;
+
+        uint8_t buffer[1500];
+        sockaddr_in from{};
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) continue;
+
+        size_t before = answers.instances.size();
+        parsePacket(buffer, (size_t)n, answers);
+        for (size_t i = before; i < answers.instances.size(); i++) {
+            senders[answers.instances[i]] = from.sin_addr;
+        }
+    }
+    close(fd);
+
+    for (const auto& entry : senders) {
+        const std::string& instance = entry.first;
+        Device device;
+        device.name = instance.substr(0, instance.find('.'));
+        device.addr.sin_family = AF_INET;
+        device.addr.sin_addr = entry.second;
+
+        // Prefer the advertised SRV/A records; fall back to the sender address
+        auto service = answers.services.find(instance);
+        if (service != answers.services.end()) {
+            device.port = service->second.port;
+            auto address = answers.addresses.find(service->second.target);
+            if (address != answers.addresses.end()) device.addr.sin_addr = address->second;
+        }
+        device.addr.sin_port = htons(device.port);
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &device.addr.sin_addr, ip, sizeof(ip));
+        device.host = ip;
+        device.resolved = true;
+        devices.push_back(device);
+    }
+    return devices;
+}
+
+}  // namespace acfleet
@@ -0,0 +1,19 @@
+#ifndef ACFLEET_MDNS_H
+#define ACFLEET_MDNS_H
+
+#include <vector>
+#include "acfleet.h"
+
+namespace acfleet {
+
+// Browse for _acremote._tcp services on the local link. Devices advertise
+// themselves this way from setupWiFi(); other web servers on the LAN
+// (printers, routers, NAS) are never returned. The query is repeated a few
+// times during the listen window and sent from an ephemeral port, so
+// responders answer by unicast (legacy mDNS query) and no multicast
+// membership is needed. Returns resolved devices.
+std::vector<Device> discover(int timeoutMs);
+
+}  // namespace acfleet
+
+#endif // ACFLEET_MDNS_H